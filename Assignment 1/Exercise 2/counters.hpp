@@ -0,0 +1,414 @@
+#ifndef counters_hpp
+#define counters_hpp
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Shared counters with the interface used by shared-variable.cpp:
+ *
+ *   counter(int threads)   threads: number of threads that will update it
+ *   void inc(int id)       id: 0 <= id < threads, the calling thread
+ *   void dec(int id)
+ *   long read()
+ *
+ * Each variant keeps the value in a different way, to compare how they
+ * scale when many threads update the same counter.
+ */
+
+const int cache_line_size = 64;
+
+/* the original version: every operation takes the same global lock */
+class mutex_counter
+{
+  std::mutex mutex;
+  long x = 0;
+
+public:
+  static constexpr const char *name = "mutex";
+
+  mutex_counter(int) {}
+
+  void inc(int)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++x;
+  }
+
+  void dec(int)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    --x;
+  }
+
+  long read()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return x;
+  }
+};
+
+/* one atomic word: no lock, but every update still moves the cache line */
+class atomic_counter
+{
+  alignas(cache_line_size) std::atomic<long> x{0};
+
+public:
+  static constexpr const char *name = "atomic";
+
+  atomic_counter(int) {}
+
+  void inc(int)
+  {
+    x.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void dec(int)
+  {
+    x.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  long read()
+  {
+    return x.load(std::memory_order_relaxed);
+  }
+};
+
+/*
+ * One shard per thread, each on its own cache line. A shard has a single
+ * writer, so updates are a plain load and store; read() adds up the shards
+ * and is the only operation that touches other threads' lines.
+ */
+class sharded_counter
+{
+  struct alignas(cache_line_size) shard
+  {
+    std::atomic<long> value{0};
+  };
+  std::vector<shard> shards;
+
+public:
+  static constexpr const char *name = "sharded";
+
+  sharded_counter(int threads) : shards(threads) {}
+
+  void inc(int id)
+  {
+    std::atomic<long> &v = shards[id].value;
+    v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void dec(int id)
+  {
+    std::atomic<long> &v = shards[id].value;
+    v.store(v.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+  }
+
+  long read()
+  {
+    long sum = 0;
+    for (shard &s : shards)
+      {
+        sum += s.value.load(std::memory_order_relaxed);
+      }
+    return sum;
+  }
+};
+
+/*
+ * Software combining tree (Herlihy & Shavit, chapter 12), generalised from
+ * getAndIncrement to adding any value. Two threads share a leaf; a thread
+ * that meets another one on its way up hands its value over and waits, and
+ * the other carries the combined value towards the root.
+ */
+class combining_tree_counter
+{
+  enum status {IDLE, FIRST, SECOND, RESULT, ROOT};
+
+  struct alignas(cache_line_size) node
+  {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool locked = false;
+    status cstatus = IDLE;
+    long first_value = 0;
+    long second_value = 0;
+    long result = 0;
+    node *parent = nullptr;
+
+    bool precombine()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [this] { return !locked; });
+      switch (cstatus)
+        {
+        case IDLE:
+          cstatus = FIRST;
+          return true;
+        case FIRST:
+          locked = true;
+          cstatus = SECOND;
+          return false;
+        default:  // ROOT
+          return false;
+        }
+    }
+
+    long combine(long combined)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [this] { return !locked; });
+      locked = true;
+      first_value = combined;
+      if (cstatus == SECOND)
+        {
+          return first_value + second_value;
+        }
+      return first_value;
+    }
+
+    long op(long combined)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (cstatus == ROOT)
+        {
+          long prior = result;
+          result += combined;
+          return prior;
+        }
+      // SECOND: leave the value for the first thread and wait for the result
+      second_value = combined;
+      locked = false;
+      cond.notify_all();
+      cond.wait(lock, [this] { return cstatus == RESULT; });
+      locked = false;
+      cond.notify_all();
+      cstatus = IDLE;
+      return result;
+    }
+
+    void distribute(long prior)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (cstatus == FIRST)
+        {
+          cstatus = IDLE;
+          locked = false;
+        }
+      else  // SECOND
+        {
+          result = prior + first_value;
+          cstatus = RESULT;
+        }
+      cond.notify_all();
+    }
+  };
+
+  std::vector<node> nodes;
+  std::vector<node *> leaves;
+
+  long add(int id, long value)
+  {
+    std::vector<node *> stack;
+    node *leaf = leaves[id / 2];
+
+    // precombining phase: find the highest node this thread has to climb to
+    node *n = leaf;
+    while (n->precombine())
+      {
+        n = n->parent;
+      }
+    node *stop = n;
+
+    // combining phase
+    long combined = value;
+    for (n = leaf; n != stop; n = n->parent)
+      {
+        combined = n->combine(combined);
+        stack.push_back(n);
+      }
+
+    // operation phase
+    long prior = stop->op(combined);
+
+    // distribution phase
+    while (!stack.empty())
+      {
+        stack.back()->distribute(prior);
+        stack.pop_back();
+      }
+    return prior;
+  }
+
+public:
+  static constexpr const char *name = "combining-tree";
+
+  combining_tree_counter(int threads)
+  {
+    int width = 2;
+    while (width < threads)
+      {
+        width *= 2;
+      }
+    nodes = std::vector<node>(width - 1);
+    nodes[0].cstatus = ROOT;
+    for (int i=1; i<width-1; ++i)
+      {
+        nodes[i].parent = &nodes[(i - 1) / 2];
+      }
+    for (int i=0; i<width/2; ++i)
+      {
+        leaves.push_back(&nodes[width - 2 - i]);
+      }
+  }
+
+  void inc(int id)
+  {
+    add(id, 1);
+  }
+
+  void dec(int id)
+  {
+    add(id, -1);
+  }
+
+  long read()
+  {
+    node &root = nodes[0];
+    std::lock_guard<std::mutex> lock(root.mutex);
+    return root.result;
+  }
+};
+
+/*
+ * Scalable non-zero indicator (Ellen, Lev, Luchangco & Moir, 2007). It does not
+ * keep the value, only whether it is above zero: inc() is arrive and dec() is
+ * depart, and a thread may only depart after its own arrive. A node only passes
+ * an arrive to its parent when its own surplus goes from zero to non-zero, so
+ * most updates stay in the lower levels of the tree. The root is a plain atomic
+ * counter, and read() returns 1 while it is non-zero.
+ */
+class snzi_counter
+{
+  /* counter (in halves, so that 1 is the intermediate 1/2 state) and version in one word */
+  struct alignas(cache_line_size) node
+  {
+    std::atomic<uint64_t> x{0};
+    node *parent = nullptr;
+  };
+
+  static uint64_t pack(uint32_t c, uint32_t v) { return ((uint64_t)v << 32) | c; }
+  static uint32_t count(uint64_t x) { return (uint32_t)x; }
+  static uint32_t version(uint64_t x) { return (uint32_t)(x >> 32); }
+
+  alignas(cache_line_size) std::atomic<long> root{0};
+  std::vector<node> nodes;
+  std::vector<node *> leaves;
+
+  void arrive(node *n)
+  {
+    if (n == nullptr)
+      {
+        root.fetch_add(1);
+        return;
+      }
+    bool success = false;
+    int undo = 0;
+    while (!success)
+      {
+        uint64_t x = n->x.load();
+        uint64_t expected = x;
+        if (count(x) >= 2)
+          {
+            if (n->x.compare_exchange_strong(expected, pack(count(x) + 2, version(x))))
+              {
+                success = true;
+              }
+          }
+        if (count(x) == 0)
+          {
+            uint64_t half = pack(1, version(x) + 1);
+            if (n->x.compare_exchange_strong(expected, half))
+              {
+                success = true;
+                x = half;
+              }
+          }
+        if (count(x) == 1)
+          {
+            arrive(n->parent);
+            expected = x;
+            if (!n->x.compare_exchange_strong(expected, pack(2, version(x))))
+              {
+                ++undo;
+              }
+          }
+      }
+    while (undo-- > 0)
+      {
+        depart(n->parent);
+      }
+  }
+
+  void depart(node *n)
+  {
+    if (n == nullptr)
+      {
+        root.fetch_sub(1);
+        return;
+      }
+    while (true)
+      {
+        uint64_t x = n->x.load();
+        if (n->x.compare_exchange_strong(x, pack(count(x) - 2, version(x))))
+          {
+            if (count(x) == 2)
+              {
+                depart(n->parent);
+              }
+            return;
+          }
+      }
+  }
+
+public:
+  static constexpr const char *name = "snzi";
+
+  snzi_counter(int threads)
+  {
+    int width = 2;
+    while (width < threads)
+      {
+        width *= 2;
+      }
+    nodes = std::vector<node>(width - 1);
+    for (int i=1; i<width-1; ++i)
+      {
+        nodes[i].parent = &nodes[(i - 1) / 2];
+      }
+    for (int i=0; i<width/2; ++i)
+      {
+        leaves.push_back(&nodes[width - 2 - i]);
+      }
+  }
+
+  void inc(int id)
+  {
+    arrive(leaves[id / 2]);
+  }
+
+  void dec(int id)
+  {
+    depart(leaves[id / 2]);
+  }
+
+  long read()
+  {
+    return root.load() > 0 ? 1 : 0;
+  }
+};
+
+#endif // counters_hpp
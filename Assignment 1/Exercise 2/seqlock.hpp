@@ -0,0 +1,175 @@
+#ifndef seqlock_hpp
+#define seqlock_hpp
+
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Ways to share a small value between writers and readers:
+ *
+ *   void update(F f)   f(T&) changes the value, writers exclude each other
+ *   T read()           returns a consistent copy of the value
+ *
+ * The value is kept as relaxed atomic words, so T has to be trivially
+ * copyable and a whole number of words.
+ */
+
+template<typename T>
+class atomic_words
+{
+  static_assert(std::is_trivially_copyable<T>::value, "T has to be trivially copyable");
+  static_assert(sizeof(T) % sizeof(unsigned long) == 0, "T has to be a whole number of words");
+  static const int words = sizeof(T) / sizeof(unsigned long);
+  std::atomic<unsigned long> data[words];
+
+public:
+  atomic_words()
+  {
+    store(T());
+  }
+
+  T load()
+  {
+    unsigned long copy[words];
+    for (int i=0; i<words; ++i)
+      {
+        copy[i] = data[i].load(std::memory_order_relaxed);
+      }
+    T value;
+    std::memcpy(&value, copy, sizeof(T));
+    return value;
+  }
+
+  void store(const T &value)
+  {
+    unsigned long copy[words];
+    std::memcpy(copy, &value, sizeof(T));
+    for (int i=0; i<words; ++i)
+      {
+        data[i].store(copy[i], std::memory_order_relaxed);
+      }
+  }
+};
+
+/* the original version: readers take the writers' lock */
+template<typename T>
+class locked
+{
+  std::mutex mutex;
+  T value = T();
+
+public:
+  static constexpr const char *name = "mutex";
+
+  template<typename F>
+  void update(F f)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    f(value);
+  }
+
+  T read()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return value;
+  }
+};
+
+/*
+ * Sequence lock: a writer makes the sequence number odd while it changes the
+ * value and even again when it is done. Readers write nothing; they copy the
+ * value and retry if the sequence number was odd or changed meanwhile, so
+ * they never delay a writer (but may wait for one).
+ */
+template<typename T>
+class seqlock
+{
+  std::atomic<unsigned> sequence{0};
+  std::mutex writer;
+  atomic_words<T> value;
+
+public:
+  static constexpr const char *name = "seqlock";
+
+  template<typename F>
+  void update(F f)
+  {
+    std::lock_guard<std::mutex> lock(writer);
+    unsigned s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    T v = value.load();
+    f(v);
+    value.store(v);
+    sequence.store(s + 2, std::memory_order_release);
+  }
+
+  T read()
+  {
+    while (true)
+      {
+        unsigned s = sequence.load(std::memory_order_acquire);
+        if (s & 1)
+          {
+            continue;  // a writer is in the middle of an update
+          }
+        T v = value.load();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == s)
+          {
+            return v;
+          }
+      }
+  }
+};
+
+/*
+ * Double-buffered snapshot (a "latch" in Linux terms): the writer keeps two
+ * copies and updates them one after the other, pointing readers at the copy
+ * that is not being written. Readers never wait for a writer; they only
+ * retry when a whole update happened during their read.
+ */
+template<typename T>
+class snapshot
+{
+  std::atomic<unsigned> sequence{0};
+  std::mutex writer;
+  T master = T();
+  atomic_words<T> copies[2];
+
+public:
+  static constexpr const char *name = "snapshot";
+
+  template<typename F>
+  void update(F f)
+  {
+    std::lock_guard<std::mutex> lock(writer);
+    f(master);
+    unsigned s = sequence.load(std::memory_order_relaxed);
+    // readers move to copies[1] while copies[0] is written, then back; the
+    // release also publishes the copies[1] stores of the previous update
+    sequence.store(s + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    copies[0].store(master);
+    sequence.store(s + 2, std::memory_order_release);
+    copies[1].store(master);
+  }
+
+  T read()
+  {
+    while (true)
+      {
+        unsigned s = sequence.load(std::memory_order_acquire);
+        T v = copies[s & 1].load();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == s)
+          {
+            return v;
+          }
+      }
+  }
+};
+
+#endif // seqlock_hpp
@@ -1,64 +1,252 @@
 #include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
 #include <thread>
-#include <mutex>
+#include <atomic>
 #include <chrono>
 
-std::mutex mutex;
+#include "counters.hpp"
+#include "seqlock.hpp"
 
-long x = 0;
-bool run = true;
+/*
+ * Throughput of the counters in counters.hpp. As in the original program,
+ * inc() and dec() threads update x while a print() thread keeps reading it,
+ * but now with any number of updating threads. Each updating thread alternates
+ * inc and dec, which keeps the value bounded and is what the snzi counter
+ * requires (a thread departs only after its own arrive).
+ */
 
-void inc()
+std::atomic<bool> run;
+
+struct alignas(cache_line_size) result
+{
+  long ops = 0;
+};
+
+template<typename Counter>
+void inc_dec(Counter *x, int id, result *r)
 {
-  bool r = true;
-  while (r)
+  long ops = 0;
+  while (run.load(std::memory_order_relaxed))
     {
-      mutex.lock();
-      ++x;
-      r = run;
-      mutex.unlock();
+      x->inc(id);
+      x->dec(id);
+      ops += 2;
     }
+  r->ops = ops;
 }
 
-void dec()
+template<typename Counter>
+void print(Counter *x, result *r)
 {
-  bool r = true;
-  while (r)
+  long reads = 0;
+  volatile long value;
+  while (run.load(std::memory_order_relaxed))
     {
-      mutex.lock();
-      --x;
-      r = run;
-      mutex.unlock();
+      value = x->read();
+      ++reads;
     }
+  (void)value;
+  r->ops = reads;
 }
 
-void print()
+template<typename Counter>
+void benchmark(int threads, double seconds)
 {
-  bool r = true;
-  while (r)
+  Counter x(threads);
+  std::vector<result> results(threads + 1);
+  std::vector<std::thread> t;
+
+  run = true;
+  for (int i=0; i<threads; ++i)
     {
-      mutex.lock();
-      std::cout << x << std::endl;
-      r = run;
-      mutex.unlock();
+      t.emplace_back(inc_dec<Counter>, &x, i, &results[i]);
     }
+  t.emplace_back(print<Counter>, &x, &results[threads]);
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  run = false;
+
+  for (auto &thread : t)
+    {
+      thread.join();
+    }
+
+  long updates = 0;
+  for (int i=0; i<threads; ++i)
+    {
+      updates += results[i].ops;
+    }
+  std::cout << std::setw(16) << Counter::name << std::setw(9) << threads
+            << std::setw(16) << std::fixed << std::setprecision(2) << updates / seconds / 1e6
+            << std::setw(14) << results[threads].ops / seconds / 1e6
+            << std::setw(8) << x.read() << std::endl;
 }
 
-int main(int argc, char *argv[], char* envp[])
+template<typename Counter>
+void sweep(int max_threads, double seconds)
+{
+  for (int threads=1; threads<max_threads; threads*=2)
+    {
+      benchmark<Counter>(threads, seconds);
+    }
+  benchmark<Counter>(max_threads, seconds);
+}
+
+/*
+ * The original three threads (inc, dec, print) with the value behind a mutex,
+ * a seqlock or a double-buffered snapshot. The value carries x and the number
+ * of updates, which always have the same parity, so a reader that sees a
+ * half-written value notices. Writer throughput is measured with the print()
+ * thread idle and with it reading as fast as it can.
+ */
+
+struct shared_value
+{
+  long x;
+  long updates;
+};
+
+template<typename Shared>
+void writer(Shared *shared, long delta, result *r)
+{
+  long ops = 0;
+  while (run.load(std::memory_order_relaxed))
+    {
+      shared->update([delta](shared_value &v) { v.x += delta; ++v.updates; });
+      ++ops;
+    }
+  r->ops = ops;
+}
+
+template<typename Shared>
+void reader(Shared *shared, result *r, long *torn)
+{
+  long reads = 0;
+  long bad = 0;
+  while (run.load(std::memory_order_relaxed))
+    {
+      shared_value v = shared->read();
+      if ((v.x - v.updates) % 2 != 0)
+        {
+          ++bad;
+        }
+      ++reads;
+    }
+  r->ops = reads;
+  *torn = bad;
+}
+
+template<typename Shared>
+void reader_benchmark(bool busy_reader, double seconds)
 {
-  std::thread t1(inc);
-  std::thread t2(dec);
-  std::thread t3(print);
+  Shared shared;
+  std::vector<result> results(3);
+  long torn = 0;
+  std::vector<std::thread> t;
 
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  run = true;
+  t.emplace_back(writer<Shared>, &shared, 1, &results[0]);
+  t.emplace_back(writer<Shared>, &shared, -1, &results[1]);
+  if (busy_reader)
+    {
+      t.emplace_back(reader<Shared>, &shared, &results[2], &torn);
+    }
 
-  mutex.lock();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
   run = false;
-  mutex.unlock();
 
-  t1.join();
-  t2.join();
-  t3.join();
+  for (auto &thread : t)
+    {
+      thread.join();
+    }
+
+  std::cout << std::setw(10) << Shared::name << std::setw(8) << (busy_reader ? "busy" : "none")
+            << std::setw(16) << std::fixed << std::setprecision(2)
+            << (results[0].ops + results[1].ops) / seconds / 1e6
+            << std::setw(14) << results[2].ops / seconds / 1e6
+            << std::setw(8) << torn << std::endl;
+}
+
+template<typename Shared>
+void reader_sweep(double seconds)
+{
+  reader_benchmark<Shared>(false, seconds);
+  reader_benchmark<Shared>(true, seconds);
+}
+
+void usage(char *program)
+{
+  std::cout << "Usage: " << program << " [T] [S]" << std::endl;
+  std::cout << "       " << program << " readers [S]" << std::endl;
+  std::cout << std::endl;
+  std::cout << "  T: largest number of updating threads (default: 2)" << std::endl;
+  std::cout << "  S: seconds per measurement (default: 1)" << std::endl;
+  exit(1);
+}
+
+int main(int argc, char *argv[], char* envp[])
+{
+  if (argc >= 2 && std::string(argv[1]) == "readers")
+    {
+      double seconds = 1.0;
+      try
+        {
+          if (argc > 2)
+            {
+              seconds = std::stod(argv[2]);
+            }
+        }
+      catch (const std::exception &)
+        {
+          usage(argv[0]);
+        }
+      if (argc > 3 || seconds <= 0)
+        {
+          usage(argv[0]);
+        }
+
+      std::cout << std::setw(10) << "value" << std::setw(8) << "reader"
+                << std::setw(16) << "updates [M/s]" << std::setw(14) << "reads [M/s]"
+                << std::setw(8) << "torn" << std::endl;
+      reader_sweep<locked<shared_value>>(seconds);
+      reader_sweep<seqlock<shared_value>>(seconds);
+      reader_sweep<snapshot<shared_value>>(seconds);
+      return 0;
+    }
+
+  int threads = 2;
+  double seconds = 1.0;
+  try
+    {
+      if (argc > 1)
+        {
+          threads = std::stoi(argv[1]);
+        }
+      if (argc > 2)
+        {
+          seconds = std::stod(argv[2]);
+        }
+    }
+  catch (const std::exception &)
+    {
+      usage(argv[0]);
+    }
+  if (argc > 3 || threads < 1 || seconds <= 0)
+    {
+      usage(argv[0]);
+    }
+
+  std::cout << std::setw(16) << "counter" << std::setw(9) << "threads"
+            << std::setw(16) << "updates [M/s]" << std::setw(14) << "reads [M/s]"
+            << std::setw(8) << "final" << std::endl;
+
+  sweep<mutex_counter>(threads, seconds);
+  sweep<atomic_counter>(threads, seconds);
+  sweep<sharded_counter>(threads, seconds);
+  sweep<combining_tree_counter>(threads, seconds);
+  sweep<snzi_counter>(threads, seconds);
 
   return 0;
 }
@@ -1,18 +1,12 @@
 #include <iostream>
 #include <thread>
-#include <mutex>
 
-std::mutex mutex;
+#include "../async_log.hpp"
 
 void loop(int n)
 {
-  mutex.lock();
-  std::cout << "Task " << n << " is running." << std::endl;
-  mutex.unlock();
-
-  mutex.lock();
-  std::cout << "Task " << n << " is terminating." << std::endl;
-  mutex.unlock();
+  async_log("Task {} is running.", n);
+  async_log("Task {} is terminating.", n);
 }
 
 int main(int argc, char *argv[], char* envp[])
@@ -1,6 +1,32 @@
 #include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <new>
+#include <random>
+#include <cstdint>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HAVE_STREAMING_STORES 1
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define HAVE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
 
 const int iterations = 100;
 
@@ -18,14 +44,567 @@ void loop(char *data, int size)
 void usage(char *program)
 {
   std::cout << "Usage: " << program << " T N" << std::endl;
+  std::cout << "       " << program << " stream T N [pin] [nt]" << std::endl;
+  std::cout << "       " << program << " latency N [huge|thp]" << std::endl;
+  std::cout << "       " << program << " sharing T [same|adjacent|page|S] [E]" << std::endl;
   std::cout << std::endl;
-  std::cout << "  T: number of threads" << std::endl;
-  std::cout << "  N: array size in MB" << std::endl;
+  std::cout << "  T: number of threads (stream: largest thread count of the sweep)" << std::endl;
+  std::cout << "  N: array size in MB (stream: size of each of the three arrays," << std::endl;
+  std::cout << "     latency: largest working set of the 4 KB, 8 KB, ... ladder)" << std::endl;
+  std::cout << "  pin: bind thread i to CPU i" << std::endl;
+  std::cout << "  nt: use non-temporal (streaming) stores" << std::endl;
+  std::cout << "  huge: allocate with MAP_HUGETLB (needs reserved huge pages)" << std::endl;
+  std::cout << "  thp: allocate with madvise(MADV_HUGEPAGE) (transparent huge pages)" << std::endl;
+  std::cout << "  same|adjacent|page|S: distance between the counters of neighbouring threads:" << std::endl;
+  std::cout << "     8 bytes (one cache line), 64 bytes, 4096 bytes, or S bytes (default: same)" << std::endl;
+  std::cout << "  E: counters per thread, interleaved with the other threads' (default: 1)" << std::endl;
   exit(1);
 }
 
+int parse_positive(char *arg, char *program)
+{
+  int value = 0;
+  try
+    {
+      value = std::stoi(arg);
+    }
+  catch (const std::exception &)
+    {
+      usage(program);
+    }
+  if (value < 1)
+    {
+      usage(program);
+    }
+  return value;
+}
+
+// Bind the calling thread to one CPU, so that it stays next to the memory it touched first.
+void pin_thread(int cpu)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % std::thread::hardware_concurrency(), &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)cpu;
+#endif
+}
+
+// Threads of one measurement wait for each other here, so that timing
+// only covers the kernels and not thread creation or initialisation.
+class spin_barrier
+{
+  std::atomic<int> waiting{0};
+  std::atomic<int> generation{0};
+  int threads;
+
+public:
+  spin_barrier(int threads) : threads(threads) {}
+
+  void wait()
+  {
+    int gen = generation.load();
+    if (waiting.fetch_add(1) + 1 == threads)
+      {
+        waiting.store(0);
+        generation.fetch_add(1);
+      }
+    else
+      {
+        while (generation.load() == gen)
+          {
+            std::this_thread::yield();
+          }
+      }
+  }
+};
+
+/*
+ * STREAM-style bandwidth suite: copy (c = a), scale (b = s*c), add (c = a + b)
+ * and triad (a = b + s*c) over three arrays of doubles. Every thread works on its
+ * own contiguous chunk and touches it first, so the pages are placed on its node.
+ */
+
+enum stream_kernel {COPY, SCALE, ADD, TRIAD, KERNELS};
+const char *kernel_names[KERNELS] = {"copy", "scale", "add", "triad"};
+const int kernel_arrays[KERNELS] = {2, 2, 3, 3};  // arrays read or written per element
+const int stream_repetitions = 10;
+const double scalar = 3.0;
+
+struct stream_config
+{
+  double *a, *b, *c;
+  long elements;
+  int threads;
+  bool pin;
+  bool nt;
+};
+
+void run_kernel(stream_kernel kernel, double *a, double *b, double *c, long n, bool nt)
+{
+#ifdef HAVE_STREAMING_STORES
+  if (nt)
+    {
+      // chunks start on a cache line and hold a multiple of 8 doubles
+      __m128d s = _mm_set1_pd(scalar);
+      for (long j=0; j<n; j+=2)
+        {
+          switch (kernel)
+            {
+            case COPY:
+              _mm_stream_pd(&c[j], _mm_load_pd(&a[j]));
+              break;
+            case SCALE:
+              _mm_stream_pd(&b[j], _mm_mul_pd(s, _mm_load_pd(&c[j])));
+              break;
+            case ADD:
+              _mm_stream_pd(&c[j], _mm_add_pd(_mm_load_pd(&a[j]), _mm_load_pd(&b[j])));
+              break;
+            default:
+              _mm_stream_pd(&a[j], _mm_add_pd(_mm_load_pd(&b[j]), _mm_mul_pd(s, _mm_load_pd(&c[j]))));
+              break;
+            }
+        }
+      _mm_sfence();
+      return;
+    }
+#else
+  (void)nt;
+#endif
+  switch (kernel)
+    {
+    case COPY:
+      for (long j=0; j<n; ++j) c[j] = a[j];
+      break;
+    case SCALE:
+      for (long j=0; j<n; ++j) b[j] = scalar * c[j];
+      break;
+    case ADD:
+      for (long j=0; j<n; ++j) c[j] = a[j] + b[j];
+      break;
+    default:
+      for (long j=0; j<n; ++j) a[j] = b[j] + scalar * c[j];
+      break;
+    }
+}
+
+void stream_worker(int id, stream_config *config, spin_barrier *barrier, double *best)
+{
+  if (config->pin)
+    {
+      pin_thread(id);
+    }
+
+  // split in whole cache lines (8 doubles), the last thread takes the rest
+  long chunk = (config->elements / config->threads) & ~7L;
+  long begin = id * chunk;
+  long n = (id == config->threads - 1) ? config->elements - begin : chunk;
+  double *a = config->a + begin;
+  double *b = config->b + begin;
+  double *c = config->c + begin;
+
+  // first touch
+  for (long j=0; j<n; ++j)
+    {
+      a[j] = 1.0;
+      b[j] = 2.0;
+      c[j] = 0.0;
+    }
+
+  for (int k=0; k<KERNELS; ++k)
+    {
+      for (int r=0; r<stream_repetitions; ++r)
+        {
+          barrier->wait();
+          auto start_time = std::chrono::steady_clock::now();
+          run_kernel((stream_kernel)k, a, b, c, n, config->nt);
+          barrier->wait();
+          std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+
+          // thread 0 times the slowest thread, the first repetition warms up
+          if (id == 0 && r > 0)
+            {
+              best[k] = std::min(best[k], duration.count());
+            }
+        }
+    }
+}
+
+void stream(int max_threads, long bytes_per_array, bool pin, bool nt)
+{
+#ifndef HAVE_STREAMING_STORES
+  if (nt)
+    {
+      std::cout << "Non-temporal stores are not available, using normal stores." << std::endl;
+    }
+#endif
+  long elements = bytes_per_array / sizeof(double);
+
+  std::cout << std::setw(8) << "threads" << std::setw(8) << "kernel"
+            << std::setw(14) << "best [s]" << std::setw(12) << "GB/s" << std::endl;
+
+  std::vector<int> counts;
+  for (int t=1; t<max_threads; t*=2)
+    {
+      counts.push_back(t);
+    }
+  counts.push_back(max_threads);
+
+  for (int threads : counts)
+    {
+      // not initialised here: the pages are placed by the first touch of their thread
+      stream_config config;
+      config.a = static_cast<double *>(::operator new(elements * sizeof(double), std::align_val_t(64)));
+      config.b = static_cast<double *>(::operator new(elements * sizeof(double), std::align_val_t(64)));
+      config.c = static_cast<double *>(::operator new(elements * sizeof(double), std::align_val_t(64)));
+      config.elements = elements;
+      config.threads = threads;
+      config.pin = pin;
+      config.nt = nt;
+
+      spin_barrier barrier(threads);
+      double best[KERNELS];
+      std::fill(best, best + KERNELS, 1e30);
+
+      std::vector<std::thread> t;
+      for (int i=0; i<threads; ++i)
+        {
+          t.emplace_back(stream_worker, i, &config, &barrier, best);
+        }
+      for (auto &thread : t)
+        {
+          thread.join();
+        }
+
+      for (int k=0; k<KERNELS; ++k)
+        {
+          double gbytes = (double)kernel_arrays[k] * elements * sizeof(double) / 1e9;
+          std::cout << std::setw(8) << threads << std::setw(8) << kernel_names[k]
+                    << std::setw(14) << std::fixed << std::setprecision(6) << best[k]
+                    << std::setw(12) << std::setprecision(2) << gbytes / best[k] << std::endl;
+        }
+
+      ::operator delete(config.a, std::align_val_t(64));
+      ::operator delete(config.b, std::align_val_t(64));
+      ::operator delete(config.c, std::align_val_t(64));
+    }
+}
+
+/*
+ * Latency ladder: a pointer chase through one randomly ordered cycle over all cache
+ * lines of the working set. Every load depends on the previous one and the order
+ * defeats the prefetchers, so the time per load steps up each time the working set
+ * outgrows a cache level or the reach of the TLB.
+ */
+
+enum page_mode {SMALL_PAGES, HUGETLB_PAGES, TRANSPARENT_HUGE_PAGES};
+const long chase_loads = 1L << 24;
+
+struct cache_line
+{
+  cache_line *next;
+  char pad[64 - sizeof(cache_line *)];
+};
+
+// keeps the chase from being optimised away
+cache_line *volatile chase_sink;
+
+#ifdef __linux__
+const long huge_page_size = 2L << 20;
+
+// MAP_HUGETLB mappings (and their munmap) must be whole huge pages
+long mapping_size(long bytes, page_mode mode)
+{
+  if (mode == HUGETLB_PAGES)
+    {
+      return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+  return bytes;
+}
+#endif
+
+void *allocate_pages(long bytes, page_mode mode)
+{
+#ifdef __linux__
+  bytes = mapping_size(bytes, mode);
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (mode == HUGETLB_PAGES)
+    {
+      flags |= MAP_HUGETLB;
+    }
+  void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (memory == MAP_FAILED)
+    {
+      std::cout << "mmap of " << bytes << " bytes failed"
+                << (mode == HUGETLB_PAGES ? " (are enough huge pages reserved in /proc/sys/vm/nr_hugepages?)" : "")
+                << std::endl;
+      exit(1);
+    }
+  if (mode == TRANSPARENT_HUGE_PAGES)
+    {
+      madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+  return memory;
+#else
+  if (mode != SMALL_PAGES)
+    {
+      std::cout << "Huge pages are only supported on Linux, using normal pages." << std::endl;
+    }
+  return ::operator new(bytes, std::align_val_t(4096));
+#endif
+}
+
+void free_pages(void *memory, long bytes, page_mode mode)
+{
+#ifdef __linux__
+  if (munmap(memory, mapping_size(bytes, mode)) != 0)
+    {
+      std::cout << "munmap of " << bytes << " bytes failed: " << strerror(errno) << std::endl;
+    }
+#else
+  (void)bytes;
+  (void)mode;
+  ::operator delete(memory, std::align_val_t(4096));
+#endif
+}
+
+double chase(cache_line *lines, long count, std::mt19937_64 &engine)
+{
+  // Sattolo's algorithm gives a single cycle through all lines
+  std::vector<long> order(count);
+  for (long i=0; i<count; ++i)
+    {
+      order[i] = i;
+    }
+  for (long i=count-1; i>0; --i)
+    {
+      std::uniform_int_distribution<long> pick(0, i-1);
+      std::swap(order[i], order[pick(engine)]);
+    }
+  for (long i=0; i<count; ++i)
+    {
+      lines[i].next = &lines[order[i]];
+    }
+
+  // warm up caches and TLB with one round through the cycle
+  cache_line *p = &lines[0];
+  for (long i=0; i<std::min(count, chase_loads); ++i)
+    {
+      p = p->next;
+    }
+
+  auto start_time = std::chrono::steady_clock::now();
+  for (long i=0; i<chase_loads; i+=8)
+    {
+      p = p->next->next->next->next->next->next->next->next;
+    }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start_time;
+
+  chase_sink = p;
+
+  return duration.count() / chase_loads;
+}
+
+void latency(long max_bytes, page_mode mode)
+{
+  cache_line *lines = static_cast<cache_line *>(allocate_pages(max_bytes, mode));
+  std::mt19937_64 engine(42);
+
+  std::cout << std::setw(14) << "working set" << std::setw(14) << "ns per load" << std::endl;
+  for (long bytes=4096; bytes<=max_bytes; bytes*=2)
+    {
+      double ns = chase(lines, bytes / sizeof(cache_line), engine);
+      std::string size = bytes >= (1L << 30) ? std::to_string(bytes >> 30) + " GB"
+        : bytes >= (1L << 20) ? std::to_string(bytes >> 20) + " MB"
+        : std::to_string(bytes >> 10) + " KB";
+      std::cout << std::setw(14) << size << std::setw(14) << std::fixed << std::setprecision(2) << ns << std::endl;
+    }
+
+  free_pages(lines, max_bytes, mode);
+}
+
+/*
+ * False sharing: every thread increments its own counters, nothing is shared
+ * logically. Counter k of thread t lives at (k * threads + t) * stride bytes, so
+ * the stride decides whether neighbouring threads write the same cache line,
+ * adjacent lines or different pages.
+ */
+
+const long sharing_updates = 1L << 24;  // per thread
+
+uint64_t ticks()
+{
+#ifdef HAVE_RDTSC
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void sharing_worker(int id, char *base, int threads, long stride, int elements,
+                    spin_barrier *barrier, double *ticks_per_update)
+{
+  std::vector<volatile long *> counters(elements);
+  for (int k=0; k<elements; ++k)
+    {
+      counters[k] = reinterpret_cast<volatile long *>(base + (k * (long)threads + id) * stride);
+    }
+
+  barrier->wait();
+  uint64_t start = ticks();
+  for (long i=0; i<sharing_updates; i+=elements)
+    {
+      for (int k=0; k<elements; ++k)
+        {
+          ++*counters[k];
+        }
+    }
+  uint64_t end = ticks();
+  barrier->wait();
+
+  ticks_per_update[id] = (double)(end - start) / sharing_updates;
+}
+
+void sharing(int max_threads, long stride, int elements)
+{
+#ifdef HAVE_RDTSC
+  const char *unit = "cycles per update";
+#else
+  const char *unit = "ns per update";
+#endif
+  std::cout << "stride " << stride << " bytes, " << elements << " counter(s) per thread" << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(20) << unit << std::endl;
+
+  std::vector<int> counts;
+  for (int t=1; t<max_threads; t*=2)
+    {
+      counts.push_back(t);
+    }
+  counts.push_back(max_threads);
+
+  for (int threads : counts)
+    {
+      long bytes = (long)elements * threads * stride;
+      char *base = static_cast<char *>(::operator new(bytes, std::align_val_t(4096)));
+      std::fill(base, base + bytes, 0);
+
+      spin_barrier barrier(threads);
+      std::vector<double> ticks_per_update(threads);
+      std::vector<std::thread> t;
+      for (int i=0; i<threads; ++i)
+        {
+          t.emplace_back(sharing_worker, i, base, threads, stride, elements, &barrier, ticks_per_update.data());
+        }
+      for (auto &thread : t)
+        {
+          thread.join();
+        }
+
+      double sum = 0;
+      for (double v : ticks_per_update)
+        {
+          sum += v;
+        }
+      std::cout << std::setw(8) << threads << std::setw(20) << std::fixed << std::setprecision(2)
+                << sum / threads << std::endl;
+
+      ::operator delete(base, std::align_val_t(4096));
+    }
+}
+
 int main(int argc, char *argv[])
 {
+  if (argc >= 4 && std::string(argv[1]) == "stream")
+    {
+      int threads = parse_positive(argv[2], argv[0]);
+      long size = parse_positive(argv[3], argv[0]) * 1024L * 1024L;
+      bool pin = false;
+      bool nt = false;
+      for (int i=4; i<argc; ++i)
+        {
+          std::string option = argv[i];
+          if (option == "pin")
+            {
+              pin = true;
+            }
+          else if (option == "nt")
+            {
+              nt = true;
+            }
+          else
+            {
+              usage(argv[0]);
+            }
+        }
+      stream(threads, size, pin, nt);
+      return 0;
+    }
+
+  if ((argc == 3 || argc == 4) && std::string(argv[1]) == "latency")
+    {
+      long size = parse_positive(argv[2], argv[0]) * 1024L * 1024L;
+      page_mode mode = SMALL_PAGES;
+      if (argc == 4)
+        {
+          std::string option = argv[3];
+          if (option == "huge")
+            {
+              mode = HUGETLB_PAGES;
+            }
+          else if (option == "thp")
+            {
+              mode = TRANSPARENT_HUGE_PAGES;
+            }
+          else
+            {
+              usage(argv[0]);
+            }
+        }
+      latency(size, mode);
+      return 0;
+    }
+
+  if (argc >= 3 && argc <= 5 && std::string(argv[1]) == "sharing")
+    {
+      int threads = parse_positive(argv[2], argv[0]);
+      long stride = 8;
+      int elements = 1;
+      if (argc >= 4)
+        {
+          std::string option = argv[3];
+          if (option == "same")
+            {
+              stride = 8;
+            }
+          else if (option == "adjacent")
+            {
+              stride = 64;
+            }
+          else if (option == "page")
+            {
+              stride = 4096;
+            }
+          else
+            {
+              stride = parse_positive(argv[3], argv[0]);
+            }
+        }
+      if (argc == 5)
+        {
+          elements = parse_positive(argv[4], argv[0]);
+        }
+      if (stride % sizeof(long) != 0)
+        {
+          std::cout << "The stride should be a multiple of " << sizeof(long) << " bytes." << std::endl;
+          exit(1);
+        }
+      sharing(threads, stride, elements);
+      return 0;
+    }
+
   if (argc != 3)
     {
       usage(argv[0]);
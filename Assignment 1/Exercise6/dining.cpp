@@ -1,16 +1,22 @@
 #include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
 
-std::mutex out;
+#include "../async_log.hpp"
 
 void philosopher(int n, std::mutex *left, std::mutex *right)
 {
   while (true)
     {
-      out.lock();
-      std::cout << "Philosopher " << n << " is thinking." << std::endl;
-      out.unlock();
+      async_log("Philosopher {} is thinking.", n);
 
       if (n % 2 == 0) {
           right->lock();
@@ -21,38 +27,438 @@ void philosopher(int n, std::mutex *left, std::mutex *right)
           right->lock();
       }
 
-      out.lock();
-      std::cout << "Philosopher " << n << " picked up her left fork." << std::endl;
-      out.unlock();
+      async_log("Philosopher {} picked up her left fork.", n);
+      async_log("Philosopher {} picked up her right fork.", n);
+      async_log("Philosopher {} is eating.", n);
+      async_log("Philosopher {} is putting down her right fork.", n);
+      right->unlock();
 
-      out.lock();
-      std::cout << "Philosopher " << n << " picked up her right fork." << std::endl;
-      out.unlock();
+      async_log("Philosopher {} is putting down her left fork.", n);
+      left->unlock();
+    }
+}
 
-      out.lock();
-      std::cout << "Philosopher " << n << " is eating." << std::endl;
-      out.unlock();
+/*
+ * Benchmark: N philosophers (one thread each) eat for S seconds without any
+ * output, once per strategy for getting both forks. Philosopher i sits
+ * between fork i (left) and fork i-1 (right), as above. Thinking and eating
+ * are a short busy loop each. Reported per strategy: meals per second, the
+ * spread of meals over the philosophers (a starving philosopher shows up as
+ * a low minimum) and the time from getting hungry to eating. A philosopher
+ * still waiting when the run ends has waited until the end, so a starving
+ * philosopher shows up in the maximum wait as well.
+ */
 
-      out.lock();
-      std::cout << "Philosopher " << n << " is putting down her right fork." << std::endl;
-      out.unlock();
-      right->unlock();
+typedef std::chrono::steady_clock bench_clock;
 
-      out.lock();
-      std::cout << "Philosopher " << n << " is putting down her left fork." << std::endl;
-      out.unlock();
-      left->unlock();
+const int cache_line_size = 64;
+const int busy_iterations = 200;
+
+std::atomic<bool> go;
+std::atomic<bool> stop;
+// end of the run: set before go, checked by the philosophers themselves, as
+// the main thread may wake up late when there are more threads than cores
+bench_clock::time_point deadline;
+
+struct alignas(cache_line_size) philosopher_stats
+{
+  long meals = 0;
+  long waits = 0;       // meals, and a wait cut off by the end of the run
+  double wait_sum = 0;  // seconds
+  double wait_max = 0;
+
+  void add_wait(bench_clock::time_point hungry, bench_clock::time_point eating)
+  {
+    double wait = std::chrono::duration<double>(eating - hungry).count();
+    ++waits;
+    wait_sum += wait;
+    wait_max = std::max(wait_max, wait);
+  }
+};
+
+void busy(int iterations)
+{
+  for (volatile int i=0; i<iterations; ++i)
+    {
+    }
+}
+
+/* resource ordering, as in philosopher(): even philosophers take the right fork first */
+struct ordering_table
+{
+  static constexpr const char *name = "ordering";
+  std::vector<std::mutex> forks;
+
+  ordering_table(int n) : forks(n) {}
+
+  bool pick_up(int i, int left, int right)
+  {
+    if (i % 2 == 0)
+      {
+        forks[right].lock();
+        forks[left].lock();
+      }
+    else
+      {
+        forks[left].lock();
+        forks[right].lock();
+      }
+    return true;
+  }
+
+  void put_down(int, int left, int right)
+  {
+    forks[right].unlock();
+    forks[left].unlock();
+  }
+
+  void finish() {}
+};
+
+/*
+ * Both forks at once with std::lock, the deadlock avoidance behind
+ * std::scoped_lock: lock one, try the other, and if that fails release
+ * and start over with the other one.
+ */
+struct scoped_lock_table
+{
+  static constexpr const char *name = "scoped_lock";
+  std::vector<std::mutex> forks;
+
+  scoped_lock_table(int n) : forks(n) {}
+
+  bool pick_up(int, int left, int right)
+  {
+    std::lock(forks[left], forks[right]);
+    return true;
+  }
+
+  void put_down(int, int left, int right)
+  {
+    forks[right].unlock();
+    forks[left].unlock();
+  }
+
+  void finish() {}
+};
+
+/*
+ * Waiter (arbitrator): one lock guards which forks are in use, and a
+ * philosopher only sits down when both of hers are free. Each philosopher
+ * waits on her own condition variable, and a philosopher who is done only
+ * wakes her two neighbours.
+ */
+struct waiter_table
+{
+  static constexpr const char *name = "waiter";
+  int n;
+  std::mutex waiter;
+  std::vector<char> in_use;
+  std::vector<std::condition_variable> seats;
+
+  waiter_table(int n) : n(n), in_use(n, 0), seats(n) {}
+
+  bool pick_up(int i, int left, int right)
+  {
+    std::unique_lock<std::mutex> lock(waiter);
+    seats[i].wait(lock, [&] { return stop || (!in_use[left] && !in_use[right]); });
+    if (stop)
+      {
+        return false;
+      }
+    in_use[left] = in_use[right] = 1;
+    return true;
+  }
+
+  void put_down(int i, int left, int right)
+  {
+    {
+      std::lock_guard<std::mutex> lock(waiter);
+      in_use[left] = in_use[right] = 0;
+    }
+    seats[(i + 1) % n].notify_one();
+    seats[(i + n - 1) % n].notify_one();
+  }
+
+  void finish()
+  {
+    std::lock_guard<std::mutex> lock(waiter);
+    for (auto &seat : seats)
+      {
+        seat.notify_one();
+      }
+  }
+};
+
+/*
+ * Chandy-Misra, with the request messages replaced by shared state: a fork
+ * belongs to one of its two philosophers and is clean or dirty. A hungry
+ * philosopher takes a fork from her neighbour only when it is dirty and not
+ * in use, and cleans it; after eating her forks are dirty. So a philosopher
+ * who has just eaten yields to a hungry neighbour, and forks start out dirty
+ * with the lower-numbered philosopher, which keeps the precedence graph
+ * acyclic.
+ */
+struct chandy_misra_table
+{
+  static constexpr const char *name = "chandy-misra";
+
+  struct alignas(cache_line_size) fork
+  {
+    std::mutex mutex;
+    std::condition_variable cond;
+    int owner = 0;
+    bool dirty = true;
+    bool in_use = false;
+  };
+  std::vector<fork> forks;
+
+  chandy_misra_table(int n) : forks(n)
+  {
+    // fork f lies between philosophers f and f+1
+    for (int f=0; f<n; ++f)
+      {
+        forks[f].owner = std::min(f, (f + 1) % n);
+      }
+  }
+
+  bool take(int i, int f)
+  {
+    fork &k = forks[f];
+    std::unique_lock<std::mutex> lock(k.mutex);
+    k.cond.wait(lock, [&] { return stop || k.owner == i || (k.dirty && !k.in_use); });
+    if (stop)
+      {
+        return false;
+      }
+    if (k.owner != i)
+      {
+        k.owner = i;
+        k.dirty = false;
+      }
+    return true;
+  }
+
+  /* mark both forks in use if we still own them (a dirty one may have been taken meanwhile) */
+  bool sit_down(int i, int left, int right)
+  {
+    fork &a = forks[std::min(left, right)];
+    fork &b = forks[std::max(left, right)];
+    std::scoped_lock lock(a.mutex, b.mutex);
+    if (a.owner != i || b.owner != i)
+      {
+        return false;
+      }
+    a.in_use = b.in_use = true;
+    return true;
+  }
+
+  bool pick_up(int i, int left, int right)
+  {
+    do
+      {
+        if (!take(i, left) || !take(i, right))
+          {
+            return false;
+          }
+      }
+    while (!sit_down(i, left, right));
+    return true;
+  }
+
+  void put_down(int, int left, int right)
+  {
+    for (int f : {left, right})
+      {
+        {
+          std::lock_guard<std::mutex> lock(forks[f].mutex);
+          forks[f].in_use = false;
+          forks[f].dirty = true;
+        }
+        forks[f].cond.notify_all();
+      }
+  }
+
+  void finish()
+  {
+    for (auto &k : forks)
+      {
+        std::lock_guard<std::mutex> lock(k.mutex);
+        k.cond.notify_all();
+      }
+  }
+};
+
+template<typename Table>
+void bench_philosopher(Table *table, int i, int n, philosopher_stats *stats)
+{
+  int left = i;
+  int right = (i == 0 ? n : i) - 1;
+  philosopher_stats s;
+  while (!go.load())
+    {
+      std::this_thread::yield();
+    }
+  while (!stop.load(std::memory_order_relaxed))
+    {
+      busy(busy_iterations);  // think
+      auto hungry = bench_clock::now();
+      if (hungry >= deadline)
+        {
+          // thought past the end of the run: no wait to count
+          stop = true;
+          break;
+        }
+      if (!table->pick_up(i, left, right))
+        {
+          // stopped while waiting: the wait lasted until the end of the run
+          s.add_wait(hungry, deadline);
+          break;
+        }
+      auto eating = bench_clock::now();
+      if (eating >= deadline)
+        {
+          // the run ended while waiting: the meal does not count, the wait
+          // does up to the end of the run
+          table->put_down(i, left, right);
+          s.add_wait(hungry, deadline);
+          stop = true;
+          break;
+        }
+      busy(busy_iterations);  // eat
+      table->put_down(i, left, right);
+      s.add_wait(hungry, eating);
+      ++s.meals;
+    }
+  *stats = s;
+}
+
+template<typename Table>
+void bench_strategy(int n, double seconds)
+{
+  Table table(n);
+  std::vector<philosopher_stats> stats(n);
+  std::vector<std::thread> t;
+
+  go = false;
+  stop = false;
+  for (int i=0; i<n; ++i)
+    {
+      t.emplace_back(bench_philosopher<Table>, &table, i, n, &stats[i]);
+    }
+  auto start = bench_clock::now();
+  deadline = start + std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double>(seconds));
+  go = true;
+  std::this_thread::sleep_until(deadline);
+  stop = true;
+  double elapsed = std::chrono::duration<double>(deadline - start).count();
+  table.finish();
+  for (auto &thread : t)
+    {
+      thread.join();
+    }
+
+  long meals = 0;
+  long min_meals = stats[0].meals;
+  long max_meals = stats[0].meals;
+  long waits = 0;
+  double wait_sum = 0;
+  double wait_max = 0;
+  for (auto &s : stats)
+    {
+      meals += s.meals;
+      min_meals = std::min(min_meals, s.meals);
+      max_meals = std::max(max_meals, s.meals);
+      waits += s.waits;
+      wait_sum += s.wait_sum;
+      wait_max = std::max(wait_max, s.wait_max);
+    }
+  double mean = (double)meals / n;
+  double variance = 0;
+  for (auto &s : stats)
+    {
+      variance += (s.meals - mean) * (s.meals - mean);
+    }
+  double cv = mean > 0 ? std::sqrt(variance / n) / mean : 0;
+
+  std::cout << std::setw(14) << Table::name
+            << std::setw(14) << std::fixed << std::setprecision(0) << meals / elapsed
+            << std::setw(8) << min_meals << std::setw(8) << max_meals
+            << std::setw(8) << std::setprecision(3) << cv
+            << std::setw(14) << std::setprecision(2) << (waits > 0 ? wait_sum / waits * 1e6 : 0)
+            << std::setw(14) << wait_max * 1e6 << std::endl;
+}
+
+void benchmark(int n, double seconds, const std::string &strategy)
+{
+  std::cout << n << " philosophers, " << seconds << " s per strategy" << std::endl;
+  std::cout << std::setw(14) << "strategy" << std::setw(14) << "meals/s"
+            << std::setw(8) << "min" << std::setw(8) << "max" << std::setw(8) << "cv"
+            << std::setw(14) << "wait [us]" << std::setw(14) << "max wait [us]" << std::endl;
+  if (strategy == "all" || strategy == "ordering")
+    {
+      bench_strategy<ordering_table>(n, seconds);
+    }
+  if (strategy == "all" || strategy == "waiter")
+    {
+      bench_strategy<waiter_table>(n, seconds);
+    }
+  if (strategy == "all" || strategy == "chandy-misra")
+    {
+      bench_strategy<chandy_misra_table>(n, seconds);
+    }
+  if (strategy == "all" || strategy == "scoped_lock")
+    {
+      bench_strategy<scoped_lock_table>(n, seconds);
     }
 }
 
 void usage(char *program)
 {
   std::cout << "Usage: " << program << " N  (where 2<=N<=10)" << std::endl;
+  std::cout << "       " << program << " bench N [S] [ordering|waiter|chandy-misra|scoped_lock]" << std::endl;
+  std::cout << std::endl;
+  std::cout << "  bench: N philosophers (N>=2) eat for S seconds (default: 2) with each" << std::endl;
+  std::cout << "         strategy, or only the given one, without output" << std::endl;
   exit(1);
 }
 
 int main(int argc, char *argv[])
 {
+  if (argc >= 3 && argc <= 5 && std::string(argv[1]) == "bench")
+    {
+      int n = 0;
+      double seconds = 2.0;
+      std::string strategy = "all";
+      try
+        {
+          n = std::stoi(argv[2]);
+          if (argc >= 4)
+            {
+              seconds = std::stod(argv[3]);
+            }
+        }
+      catch (const std::exception &)
+        {
+          usage(argv[0]);
+        }
+      if (argc == 5)
+        {
+          strategy = argv[4];
+          if (strategy != "ordering" && strategy != "waiter" && strategy != "chandy-misra"
+              && strategy != "scoped_lock")
+            {
+              usage(argv[0]);
+            }
+        }
+      if (n < 2 || seconds <= 0)
+        {
+          usage(argv[0]);
+        }
+      benchmark(n, seconds, strategy);
+      return 0;
+    }
+
   if (argc != 2)
     {
       usage(argv[0]);
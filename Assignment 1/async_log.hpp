@@ -0,0 +1,202 @@
+#ifndef async_log_hpp
+#define async_log_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Asynchronous logging without a shared lock on the hot path:
+ *
+ *   async_log("Philosopher {} is eating.", n);
+ *
+ * stores a fixed-size binary record (timestamp, format string and up to four
+ * integer arguments) in the calling thread's own ring buffer, which only that
+ * thread writes and only the background thread reads. The background thread
+ * merges the rings by timestamp, formats the records (each {} is replaced by
+ * the next argument) and writes them to std::cout in batches.
+ *
+ * The format must be a string literal (only the pointer is stored). Records
+ * still in the rings at exit are written out when the logger is destroyed.
+ */
+
+const int log_cache_line_size = 64;
+
+struct alignas(log_cache_line_size) log_record
+{
+  static const int max_args = 4;
+
+  int64_t time;         // steady_clock nanoseconds
+  const char *format;
+  int64_t args[max_args];
+  int nargs;
+};
+
+/* single-producer single-consumer ring of log records */
+class log_ring
+{
+public:
+  static const unsigned capacity = 1024;  // a power of two
+
+  /* set while the owner is between taking a timestamp and publishing the record */
+  alignas(log_cache_line_size) std::atomic<bool> busy{false};
+  std::atomic<unsigned> tail{0};  // written by the owner
+  alignas(log_cache_line_size) std::atomic<unsigned> head{0};  // written by the logger thread
+  log_record records[capacity];
+};
+
+class async_logger
+{
+  std::mutex rings_mutex;
+  std::vector<std::unique_ptr<log_ring>> rings;
+  std::vector<log_record> pending;
+  std::atomic<bool> stopping{false};
+  std::thread writer;  // last, so it starts after the other members exist
+
+  static int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  async_logger() : writer(&async_logger::run, this) {}
+
+  ~async_logger()
+  {
+    stopping = true;
+    writer.join();
+  }
+
+  log_ring *register_thread()
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    rings.emplace_back(new log_ring());
+    return rings.back().get();
+  }
+
+  static void format(std::string &out, const log_record &r)
+  {
+    int arg = 0;
+    for (const char *c = r.format; *c; ++c)
+      {
+        if (c[0] == '{' && c[1] == '}' && arg < r.nargs)
+          {
+            out += std::to_string(r.args[arg++]);
+            ++c;
+          }
+        else
+          {
+            out += *c;
+          }
+      }
+    out += '\n';
+  }
+
+  /*
+   * One round: take the time, move everything published so far into
+   * pending, and write out the pending records older than that time in
+   * timestamp order. A record that is still being written has a later
+   * timestamp, because its thread set busy before reading the clock and we
+   * wait for busy to clear after reading it. Newer records stay pending, as
+   * another thread may still log something between them and our time.
+   */
+  bool drain(bool all)
+  {
+    int64_t bound = now();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+      for (auto &ring : rings)
+        {
+          while (ring->busy.load())
+            {
+              std::this_thread::yield();
+            }
+          unsigned head = ring->head.load(std::memory_order_relaxed);
+          unsigned tail = ring->tail.load(std::memory_order_acquire);
+          for (; head != tail; ++head)
+            {
+              pending.push_back(ring->records[head % log_ring::capacity]);
+            }
+          ring->head.store(head, std::memory_order_release);
+        }
+    }
+    if (pending.empty())
+      {
+        return false;
+      }
+
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const log_record &a, const log_record &b) { return a.time < b.time; });
+    auto end = all ? pending.end()
+                   : std::lower_bound(pending.begin(), pending.end(), bound,
+                                      [](const log_record &r, int64_t t) { return r.time < t; });
+    std::string batch;
+    for (auto r = pending.begin(); r != end; ++r)
+      {
+        format(batch, *r);
+      }
+    std::cout.write(batch.data(), batch.size());
+    std::cout.flush();
+    pending.erase(pending.begin(), end);
+    return true;
+  }
+
+  void run()
+  {
+    while (!stopping.load())
+      {
+        if (!drain(false))
+          {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+      }
+    drain(true);
+  }
+
+public:
+  static async_logger &instance()
+  {
+    static async_logger logger;
+    return logger;
+  }
+
+  template<typename... Args>
+  void log(const char *format, Args... args)
+  {
+    static_assert(sizeof...(Args) <= log_record::max_args, "too many log arguments");
+    static_assert((std::is_integral<Args>::value && ...), "log arguments have to be integers");
+    static thread_local log_ring *ring = register_thread();
+
+    unsigned tail = ring->tail.load(std::memory_order_relaxed);
+    while (tail - ring->head.load(std::memory_order_acquire) == log_ring::capacity)
+      {
+        std::this_thread::yield();  // full: wait for the logger thread
+      }
+    ring->busy.store(true);
+    log_record &r = ring->records[tail % log_ring::capacity];
+    r.time = now();
+    r.format = format;
+    r.nargs = sizeof...(Args);
+    int i = 0;
+    ((r.args[i++] = (int64_t)args), ...);
+    ring->tail.store(tail + 1, std::memory_order_release);
+    ring->busy.store(false, std::memory_order_release);
+  }
+};
+
+template<typename... Args>
+void async_log(const char *format, Args... args)
+{
+  async_logger::instance().log(format, args...);
+}
+
+#endif // async_log_hpp
@@ -6,12 +6,33 @@
 #include <cmath>
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <algorithm>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 
 void usage(char* program)
 {
-	std::cout << "Usage: " << program << " <number of threads> <number of trapezes>\n-h for help\n" << std::endl;
+	std::cout << "Usage: " << program << " <number of threads> <number of trapezes>\n"
+		<< "       " << program << " -mc <number of threads> <number of samples> <dimensions>\n"
+		<< "       " << program << " -qmc <number of threads> <number of samples> <dimensions>\n"
+#ifndef _WIN32
+		<< "       " << program << " -file <number of threads> <file of float64 samples> [a b]\n"
+#endif
+#ifdef USE_MPI
+		<< "       mpirun -np <processes> " << program << " -mpi <number of threads> <number of trapezes> [trapezes per batch]\n"
+#endif
+		<< "-h for help\n" << std::endl;
 	exit(1);
 }
 
@@ -19,11 +40,11 @@ double integralFunction(double x) {
 	return 4 / (1 + std::pow(x, 2));
 }
 
-double integration(int vector_position, int num_threads, double a, double b, int num_trapezes) {
-	double w = (b - a) / num_trapezes;
+// integrates the trapezes first..last-1 of width w that fall on this thread
+double integrationRange(int vector_position, int num_threads, double a, double w, long long first, long long last) {
 	double sum = 0;
 
-	for (int i = vector_position; i < num_trapezes; i = i + num_threads) {
+	for (long long i = first + vector_position; i < last; i = i + num_threads) {
 		double x0 = a + w * i;
 		double x1 = x0 + w;
 
@@ -35,14 +56,528 @@ double integration(int vector_position, int num_threads, double a, double b, int
 	return sum;
 }
 
+double integration(int vector_position, int num_threads, double a, double b, int num_trapezes) {
+	return integrationRange(vector_position, num_threads, a, (b - a) / num_trapezes, 0, num_trapezes);
+}
+
 void threadFunction(int vector_position, int num_threads, double a, double b, int num_trapezes, std::vector<double>& partial_integrals) {
 	partial_integrals[vector_position] = integration(vector_position, num_threads, a, b, num_trapezes);
 }
 
 
+/*
+Monte Carlo (-mc) and quasi-Monte Carlo (-qmc) integration over the box [a, b]^d.
+The samples are grouped in blocks of fixed size, and the blocks are dealt to the threads
+the same way the trapezes are dealt above. Every block keeps its own partial sums and the
+blocks are added in order at the end, so the estimate is the same for any number of threads.
+*/
+
+const int SAMPLES_PER_BLOCK = 4096;
+const int MAX_QMC_DIMENSIONS = 16;
+const int QMC_REPLICATES = 16;
+// the Sobol directions have 32 bits, so moving on from point i needs i + 1 < 2^32
+const long long MAX_QMC_POINTS = (1LL << 32) - 1;
+const uint32_t RNG_SEED = 0x5eed1234;
+
+// The d-dimensional integrand is the product of the 1-D one, so over [0, 1]^d the exact value is pi^d
+double integralFunctionND(const double* x, int dimensions) {
+	double y = 1.0;
+	for (int k = 0; k < dimensions; k++) {
+		y = y * integralFunction(x[k]);
+	}
+	return y;
+}
+
+// Philox4x32-10 counter-based generator: the random numbers of a sample only depend on
+// (counter, key), never on which thread draws them or on how many were drawn before.
+struct Philox4x32 {
+	uint32_t v[4];
+};
+
+Philox4x32 philox(uint64_t counter, uint32_t stream, uint32_t seed) {
+	uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32), c2 = stream, c3 = 0;
+	uint32_t k0 = seed, k1 = 0;
+
+	for (int round = 0; round < 10; round++) {
+		uint64_t p0 = (uint64_t)0xD2511F53 * c0;
+		uint64_t p1 = (uint64_t)0xCD9E8D57 * c2;
+		uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)p1;
+		c3 = (uint32_t)p0;
+		c0 = n0;
+		c2 = n2;
+		k0 = k0 + 0x9E3779B9;
+		k1 = k1 + 0xBB67AE85;
+	}
+	return Philox4x32{ { c0, c1, c2, c3 } };
+}
+
+// maps 32 random bits to (0, 1)
+double toUnit(uint32_t bits) {
+	return (bits + 0.5) * (1.0 / 4294967296.0);
+}
+
+// Joe-Kuo primitive polynomials (degree s, coefficients a) and initial direction numbers m
+// for the Sobol dimensions 2..16; the first dimension is the van der Corput sequence.
+struct SobolPolynomial {
+	int s;
+	int a;
+	uint32_t m[6];
+};
+
+const SobolPolynomial SOBOL_POLYNOMIALS[MAX_QMC_DIMENSIONS - 1] = {
+	{ 1, 0, { 1 } },
+	{ 2, 1, { 1, 3 } },
+	{ 3, 1, { 1, 3, 1 } },
+	{ 3, 2, { 1, 1, 1 } },
+	{ 4, 1, { 1, 1, 3, 3 } },
+	{ 4, 4, { 1, 3, 5, 13 } },
+	{ 5, 2, { 1, 1, 5, 5, 17 } },
+	{ 5, 4, { 1, 1, 5, 5, 5 } },
+	{ 5, 7, { 1, 1, 7, 11, 19 } },
+	{ 5, 11, { 1, 1, 5, 1, 1 } },
+	{ 5, 13, { 1, 1, 1, 3, 11 } },
+	{ 5, 14, { 1, 3, 5, 5, 31 } },
+	{ 6, 1, { 1, 3, 3, 9, 7, 49 } },
+	{ 6, 13, { 1, 1, 1, 15, 21, 21 } },
+	{ 6, 16, { 1, 3, 1, 13, 27, 49 } },
+};
+
+// direction numbers v[k][j], scaled to 32 bits
+std::vector<std::vector<uint32_t>> sobolDirections(int dimensions) {
+	std::vector<std::vector<uint32_t>> v(dimensions, std::vector<uint32_t>(32));
+
+	for (int j = 0; j < 32; j++) {
+		v[0][j] = (uint32_t)1 << (31 - j);
+	}
+	for (int k = 1; k < dimensions; k++) {
+		const SobolPolynomial& p = SOBOL_POLYNOMIALS[k - 1];
+		for (int j = 0; j < 32; j++) {
+			if (j < p.s) {
+				v[k][j] = p.m[j] << (31 - j);
+			}
+			else {
+				v[k][j] = v[k][j - p.s] ^ (v[k][j - p.s] >> p.s);
+				for (int l = 1; l < p.s; l++) {
+					if ((p.a >> (p.s - 1 - l)) & 1) {
+						v[k][j] = v[k][j] ^ v[k][j - l];
+					}
+				}
+			}
+		}
+	}
+	return v;
+}
+
+// Monte Carlo: each block stores the sum and the sum of squares of its samples
+void monteCarloBlocks(int vector_position, int num_threads, double a, double b, long long num_samples,
+	int dimensions, std::vector<double>& block_sums) {
+	long long num_blocks = (num_samples + SAMPLES_PER_BLOCK - 1) / SAMPLES_PER_BLOCK;
+	std::vector<double> x(dimensions);
+
+	for (long long block = vector_position; block < num_blocks; block = block + num_threads) {
+		long long first = block * SAMPLES_PER_BLOCK;
+		long long last = std::min(first + SAMPLES_PER_BLOCK, num_samples);
+		double sum = 0;
+		double sum_sq = 0;
+
+		for (long long i = first; i < last; i++) {
+			for (int k = 0; k < dimensions; k = k + 4) {
+				Philox4x32 r = philox(i, k / 4, RNG_SEED);
+				for (int l = 0; l < 4 && k + l < dimensions; l++) {
+					x[k + l] = a + (b - a) * toUnit(r.v[l]);
+				}
+			}
+			double y = integralFunctionND(x.data(), dimensions);
+			sum = sum + y;
+			sum_sq = sum_sq + y * y;
+		}
+		block_sums[2 * block] = sum;
+		block_sums[2 * block + 1] = sum_sq;
+	}
+}
+
+// Randomized quasi-Monte Carlo: the same Sobol points are evaluated under QMC_REPLICATES
+// random digital shifts, and each block stores one sum per replicate
+void quasiMonteCarloBlocks(int vector_position, int num_threads, double a, double b, long long num_points,
+	int dimensions, const std::vector<std::vector<uint32_t>>& directions,
+	const std::vector<uint32_t>& shifts, std::vector<double>& block_sums) {
+	long long num_blocks = (num_points + SAMPLES_PER_BLOCK - 1) / SAMPLES_PER_BLOCK;
+	std::vector<uint32_t> point(dimensions);
+	std::vector<double> x(dimensions);
+	std::vector<double> sums(QMC_REPLICATES);
+
+	for (long long block = vector_position; block < num_blocks; block = block + num_threads) {
+		long long first = block * SAMPLES_PER_BLOCK;
+		long long last = std::min(first + SAMPLES_PER_BLOCK, num_points);
+		std::fill(sums.begin(), sums.end(), 0.0);
+
+		// jump to the first point of the block: point i is the XOR of the directions of the bits of gray(i)
+		uint64_t gray = first ^ (first >> 1);
+		for (int k = 0; k < dimensions; k++) {
+			point[k] = 0;
+			for (int j = 0; j < 32; j++) {
+				if ((gray >> j) & 1) {
+					point[k] = point[k] ^ directions[k][j];
+				}
+			}
+		}
+
+		for (long long i = first; i < last; i++) {
+			for (int r = 0; r < QMC_REPLICATES; r++) {
+				for (int k = 0; k < dimensions; k++) {
+					x[k] = a + (b - a) * toUnit(point[k] ^ shifts[r * dimensions + k]);
+				}
+				sums[r] = sums[r] + integralFunctionND(x.data(), dimensions);
+			}
+
+			// next point in Gray code order only flips the direction of the lowest zero bit of i
+			int c = 0;
+			while ((((i + 1) >> c) & 1) == 0) {
+				c++;
+			}
+			for (int k = 0; k < dimensions; k++) {
+				point[k] = point[k] ^ directions[k][c];
+			}
+		}
+		// blocks of other threads may share the cache line, so store only once per block
+		for (int r = 0; r < QMC_REPLICATES; r++) {
+			block_sums[block * QMC_REPLICATES + r] = sums[r];
+		}
+	}
+}
+
+void monteCarlo(int num_threads, long long num_samples, int dimensions, bool quasi) {
+	// Integral description
+	double a = 0.0;
+	double b = 1.0;
+	double volume = std::pow(b - a, dimensions);
+	double estimate = 0.0;
+	double error = 0.0;
+
+	// for QMC every point is evaluated once per replicate
+	long long num_points = quasi ? num_samples / QMC_REPLICATES : num_samples;
+	long long num_blocks = (num_points + SAMPLES_PER_BLOCK - 1) / SAMPLES_PER_BLOCK;
+	int sums_per_block = quasi ? QMC_REPLICATES : 2;
+
+	std::vector<std::vector<uint32_t>> directions;
+	std::vector<uint32_t> shifts;
+	if (quasi) {
+		directions = sobolDirections(dimensions);
+		for (int r = 0; r < QMC_REPLICATES; r++) {
+			for (int k = 0; k < dimensions; k++) {
+				shifts.push_back(philox(k, r, ~RNG_SEED).v[0]);
+			}
+		}
+	}
+
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::thread> threads;
+	std::vector<double> block_sums(num_blocks * sums_per_block, 0.0);
+
+	for (int i = 0; i < num_threads; i++) {
+		if (quasi) {
+			threads.emplace_back(quasiMonteCarloBlocks, i, num_threads, a, b, num_points, dimensions,
+				std::cref(directions), std::cref(shifts), std::ref(block_sums));
+		}
+		else {
+			threads.emplace_back(monteCarloBlocks, i, num_threads, a, b, num_points, dimensions, std::ref(block_sums));
+		}
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	// add the blocks in order, independently of which thread computed them
+	if (quasi) {
+		std::vector<double> replicate(QMC_REPLICATES, 0.0);
+		for (long long block = 0; block < num_blocks; block++) {
+			for (int r = 0; r < QMC_REPLICATES; r++) {
+				replicate[r] = replicate[r] + block_sums[block * QMC_REPLICATES + r];
+			}
+		}
+		// the replicates are independent estimates, their spread gives the error
+		double sum = 0, sum_sq = 0;
+		for (int r = 0; r < QMC_REPLICATES; r++) {
+			double value = volume * replicate[r] / num_points;
+			sum = sum + value;
+			sum_sq = sum_sq + value * value;
+		}
+		estimate = sum / QMC_REPLICATES;
+		error = std::sqrt(std::max(0.0, sum_sq / QMC_REPLICATES - estimate * estimate) / (QMC_REPLICATES - 1));
+	}
+	else {
+		double sum = 0, sum_sq = 0;
+		for (long long block = 0; block < num_blocks; block++) {
+			sum = sum + block_sums[2 * block];
+			sum_sq = sum_sq + block_sums[2 * block + 1];
+		}
+		double mean = sum / num_points;
+		double variance = std::max(0.0, sum_sq / num_points - mean * mean);
+		estimate = volume * mean;
+		error = volume * std::sqrt(variance / num_points);
+	}
+
+	long long evaluated = quasi ? num_points * QMC_REPLICATES : num_points;
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+
+	std::cout << "The estimated integral with " << evaluated << (quasi ? " quasi-Monte Carlo" : " Monte Carlo")
+		<< " samples in " << dimensions << " dimensions is: " << estimate << " (error estimate: " << error << ")" << std::endl;
+	std::cout << "Exact value: " << std::pow(std::acos(-1.0), dimensions) << std::endl;
+	std::cout << "Execution time: " << elapsed.count() << " nanoseconds" << std::endl;
+	std::cout << "Throughput: " << evaluated / (elapsed.count() * 1e-9) << " samples per second" << std::endl;
+}
+
+
+
+#ifndef _WIN32
+/*
+Tabulated integrand (-file): the file holds n float64 samples y0..y(n-1) taken at equally
+spaced points of [a, b]. The file is mapped into memory, not read, and every thread integrates
+its own page-aligned range of samples straight from the mapping. The trapeze between the last
+sample of a range and the first sample of the next belongs to the left range, which reads
+that one sample from its neighbour's page.
+*/
+
+void sampleRange(const double* samples, double w, long long first, long long last, double& partial_integral) {
+	double sum = 0;
+
+	for (long long i = first; i < last; i++) {
+		sum = sum + 0.5 * (samples[i] + samples[i + 1]) * w;
+	}
+	partial_integral = sum;
+}
+
+void fileIntegration(int num_threads, const char* path, double a, double b) {
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		std::cout << "Could not open " << path << ": " << strerror(errno) << std::endl;
+		exit(1);
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size % sizeof(double) != 0 || info.st_size < (off_t)(2 * sizeof(double))) {
+		std::cout << path << " should hold at least two float64 samples." << std::endl;
+		exit(1);
+	}
+
+	size_t bytes = info.st_size;
+	const double* samples = (const double*)mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (samples == MAP_FAILED) {
+		std::cout << "Could not map " << path << ": " << strerror(errno) << std::endl;
+		exit(1);
+	}
+	close(fd);
+	// every range is read front to back once: ask for aggressive readahead and early reclaim
+	madvise((void*)samples, bytes, MADV_SEQUENTIAL);
+
+	long long num_samples = bytes / sizeof(double);
+	long long num_trapezes = num_samples - 1;
+	double w = (b - a) / num_trapezes;
+
+	// split the samples in whole pages so that no page is shared between threads
+	long long page_samples = sysconf(_SC_PAGESIZE) / sizeof(double);
+	long long num_pages = (num_samples + page_samples - 1) / page_samples;
+	long long pages_per_thread = (num_pages + num_threads - 1) / num_threads;
+
+	std::vector<std::thread> threads;
+	std::vector<double> partial_integrals(num_threads, 0.0);
+
+	for (int i = 0; i < num_threads; i++) {
+		long long first = std::min(i * pages_per_thread * page_samples, num_trapezes);
+		long long last = std::min((i + 1) * pages_per_thread * page_samples, num_trapezes);
+		threads.emplace_back(sampleRange, samples, w, first, last, std::ref(partial_integrals[i]));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	double total = 0.0;
+	for (double partial : partial_integrals) {
+		total = total + partial;
+	}
+	munmap((void*)samples, bytes);
+
+	std::cout << "The estimated integral of " << num_samples << " samples over [" << a << ", " << b << "] is: " << total << std::endl;
+
+	auto end = std::chrono::high_resolution_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+	std::cout << "Execution time: " << elapsed.count() << " nanoseconds" << std::endl;
+	std::cout << "Bandwidth: " << bytes / (elapsed.count() * 1e-9) / 1e9 << " GB/s" << std::endl;
+}
+#endif
+
+
+
+#ifdef USE_MPI
+/*
+Distributed trapezes (-mpi), compiled with: mpicxx -DUSE_MPI -O2 Integral.cpp -o integral
+The trapezes are cut in batches, and every process takes the next batch from a counter kept
+by the master (MPI_Fetch_and_op) until none are left, so fast processes take more batches.
+Every batch is integrated by the threads of the process, and its result is stored at the
+batch position; one MPI_Reduce then adds the batches in order, which makes the result
+independent of which process took which batch.
+*/
+
+const long long DEFAULT_TRAPEZES_PER_BATCH = 1 << 20;
+
+void threadBatchFunction(int vector_position, int num_threads, double a, double w, long long first, long long last,
+	std::vector<double>& partial_integrals) {
+	partial_integrals[vector_position] = integrationRange(vector_position, num_threads, a, w, first, last);
+}
+
+double threadedBatch(int num_threads, double a, double w, long long first, long long last) {
+	std::vector<std::thread> threads;
+	std::vector<double> partial_integrals(num_threads);
+	double total = 0.0;
+
+	for (int i = 0; i < num_threads; i++) {
+		threads.emplace_back(threadBatchFunction, i, num_threads, a, w, first, last, std::ref(partial_integrals));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	for (double partial : partial_integrals) {
+		total = total + partial;
+	}
+	return total;
+}
+
+void mpiIntegration(int num_threads, long long num_trapezes, long long batch_size) {
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	// Integral description
+	double a = 0.0;
+	double b = 1.0;
+	double w = (b - a) / num_trapezes;
+	long long num_batches = (num_trapezes + batch_size - 1) / batch_size;
+
+	// the shared batch counter lives in the master's window, the other processes expose nothing
+	int64_t next_batch = 0;
+	MPI_Win window;
+	MPI_Win_create(&next_batch, rank == 0 ? sizeof(int64_t) : 0, sizeof(int64_t), MPI_INFO_NULL, MPI_COMM_WORLD, &window);
+
+	std::vector<double> batch_integrals(num_batches, 0.0);
+	long long my_batches = 0;
+	const int64_t one = 1;
+
+	MPI_Win_lock_all(0, window);
+	while (true) {
+		int64_t batch;
+		MPI_Fetch_and_op(&one, &batch, MPI_INT64_T, 0, 0, MPI_SUM, window);
+		MPI_Win_flush(0, window);
+		if (batch >= num_batches) {
+			break;
+		}
+
+		long long first = batch * batch_size;
+		long long last = std::min(first + batch_size, num_trapezes);
+		batch_integrals[batch] = threadedBatch(num_threads, a, w, first, last);
+		my_batches++;
+	}
+	MPI_Win_unlock_all(window);
+
+	// every batch is non-zero on exactly one process, so the sum over processes is exact
+	std::vector<double> all_batches(rank == 0 ? num_batches : 0);
+	MPI_Reduce(batch_integrals.data(), all_batches.data(), (int)num_batches, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	MPI_Win_free(&window);
+
+	std::cout << "Process " << rank << " integrated " << my_batches << " of " << num_batches << " batches" << std::endl;
+
+	if (rank == 0) {
+		double total = 0.0;
+		for (double partial : all_batches) {
+			total = total + partial;
+		}
+		std::cout << "The estimated integral with " << num_trapezes << " trapezes on " << size << " processes is: " << total << std::endl;
+
+		auto end = std::chrono::high_resolution_clock::now();
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+		std::cout << "Execution time: " << elapsed.count() << " nanoseconds" << std::endl;
+	}
+}
+#endif
+
+
 int main(int argc, char* argv[]) {
 	auto begin = std::chrono::high_resolution_clock::now();
 
+	if (argc == 5 && (strcmp(argv[1], "-mc") == 0 || strcmp(argv[1], "-qmc") == 0)) {
+		bool quasi = strcmp(argv[1], "-qmc") == 0;
+		int num_threads = std::stoi(argv[2]);
+		long long num_samples = std::stoll(argv[3]);
+		int dimensions = std::stoi(argv[4]);
+
+		if (num_threads <= 0 || num_samples <= 0 || dimensions <= 0) {
+			std::cout << "These should be positive integers, bigger than 0." << std::endl;
+			exit(1);
+		}
+		if (quasi && dimensions > MAX_QMC_DIMENSIONS) {
+			std::cout << "Quasi-Monte Carlo supports up to " << MAX_QMC_DIMENSIONS << " dimensions." << std::endl;
+			exit(1);
+		}
+		if (quasi && num_samples < 2 * QMC_REPLICATES) {
+			std::cout << "Quasi-Monte Carlo needs at least " << 2 * QMC_REPLICATES << " samples." << std::endl;
+			exit(1);
+		}
+		if (quasi && num_samples / QMC_REPLICATES > MAX_QMC_POINTS) {
+			std::cout << "Quasi-Monte Carlo supports at most " << MAX_QMC_POINTS * QMC_REPLICATES << " samples." << std::endl;
+			exit(1);
+		}
+
+		monteCarlo(num_threads, num_samples, dimensions, quasi);
+		return 0;
+	}
+
+#ifndef _WIN32
+	if ((argc == 4 || argc == 6) && strcmp(argv[1], "-file") == 0) {
+		int num_threads = std::stoi(argv[2]);
+		double a = (argc == 6) ? std::stod(argv[4]) : 0.0;
+		double b = (argc == 6) ? std::stod(argv[5]) : 1.0;
+
+		if (num_threads <= 0) {
+			std::cout << "These should be positive integers, bigger than 0." << std::endl;
+			exit(1);
+		}
+
+		fileIntegration(num_threads, argv[3], a, b);
+		return 0;
+	}
+#endif
+
+#ifdef USE_MPI
+	if ((argc == 4 || argc == 5) && strcmp(argv[1], "-mpi") == 0) {
+		MPI_Init(&argc, &argv);
+
+		int num_threads = std::stoi(argv[2]);
+		long long num_trapezes = std::stoll(argv[3]);
+		long long batch_size = (argc == 5) ? std::stoll(argv[4]) : DEFAULT_TRAPEZES_PER_BATCH;
+
+		if (num_threads <= 0 || num_trapezes <= 0 || batch_size <= 0) {
+			std::cout << "These should be positive integers, bigger than 0." << std::endl;
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+
+		mpiIntegration(num_threads, num_trapezes, batch_size);
+
+		MPI_Finalize();
+		return 0;
+	}
+#endif
+
 	if (argc != 3) {
 		if (argc == 2 && strcmp(argv[1], "-h") == 0) {
 			std::cout << "HELP: This program accepts the total number of threads and trapezes with appropriate command-line"
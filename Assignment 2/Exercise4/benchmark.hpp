@@ -5,78 +5,361 @@
  * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
  */
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
 #include <random>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
 
-enum class worker_status {wait, work, finish};
-
 static const int RANDOM_VALUE_RANGE_MIN = 0;
 static const int RANDOM_VALUE_RANGE_MAX = 65536;
 
-/* template is used to allow functions/functors of any signature */
+/* xoshiro256** (Blackman & Vigna, 2018): a few shifts and multiplications
+ * per number instead of the mt19937 state update, so drawing numbers costs
+ * little next to the operations being measured
+ */
+class xoshiro256ss {
+	std::uint64_t s[4];
+
+	static std::uint64_t rotl(std::uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+	typedef std::uint64_t result_type;
+
+	/* the state is filled from the seed with splitmix64, as recommended */
+	explicit xoshiro256ss(std::uint64_t seed) {
+		for (auto& word : s) {
+			seed += 0x9e3779b97f4a7c15ULL;
+			std::uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			word = z ^ (z >> 31);
+		}
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	result_type operator()() {
+		std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+		std::uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	/* a number in [0, 2^31) */
+	int next_int() {
+		return static_cast<int>((*this)() >> 33);
+	}
+
+	/* a number in [0, 1) */
+	double next_double() {
+		return ((*this)() >> 11) * 0x1.0p-53;
+	}
+};
+
+enum class key_pattern {uniform, zipf, hotspot, sequential};
+
+/* the keys the workers operate on, in [0, range):
+ * uniform - every key equally likely
+ * zipf - the key of rank i has probability proportional to 1/i^theta
+ *        (Gray et al., 1994, as in YCSB)
+ * hotspot - a hot_fraction of the keys gets hot_probability of the accesses
+ * sequential - 0, 1, 2, ... wrapping around; each worker starts elsewhere
+ * For zipf and hotspot the ranks are scrambled (multiplied by a prime
+ * modulo range), so the hot keys are spread over the key space instead of
+ * sitting at the front of the list.
+ * Every worker gets its own copy.
+ */
+class key_distribution {
+	static const std::uint64_t SCRAMBLE = 2654435761ULL;
+
+	key_pattern pattern;
+	int range;
+	double theta = 0.0;
+	double alpha = 0.0;
+	double zetan = 0.0;
+	double eta = 0.0;
+	double hot_fraction = 0.0;
+	double hot_probability = 0.0;
+	unsigned next = 0;
+
+	key_distribution(key_pattern pattern, int range) : pattern(pattern), range(range) {}
+
+	static double zeta(int n, double theta) {
+		double sum = 0.0;
+		for (int i = 1; i <= n; i++) {
+			sum += 1.0 / std::pow(i, theta);
+		}
+		return sum;
+	}
+
+	int scramble(std::uint64_t rank) const {
+		return static_cast<int>(rank * SCRAMBLE % range);
+	}
+
+public:
+	static key_distribution uniform(int range) {
+		return key_distribution(key_pattern::uniform, range);
+	}
+
+	static key_distribution zipf(int range, double theta = 0.99) {
+		key_distribution d(key_pattern::zipf, range);
+		d.theta = theta;
+		d.alpha = 1.0 / (1.0 - theta);
+		d.zetan = zeta(range, theta);
+		d.eta = (1.0 - std::pow(2.0 / range, 1.0 - theta)) / (1.0 - zeta(2, theta) / d.zetan);
+		return d;
+	}
+
+	static key_distribution hotspot(int range, double hot_fraction = 0.2, double hot_probability = 0.8) {
+		key_distribution d(key_pattern::hotspot, range);
+		d.hot_fraction = hot_fraction;
+		d.hot_probability = hot_probability;
+		return d;
+	}
+
+	static key_distribution sequential(int range) {
+		return key_distribution(key_pattern::sequential, range);
+	}
+
+	/* where worker i of n starts a sequential pattern */
+	void start_worker(int i, int n) {
+		next = static_cast<unsigned>(static_cast<std::uint64_t>(range) * i / n);
+	}
+
+	int key_range() const {
+		return range;
+	}
+
+	std::string name() const {
+		std::ostringstream ss;
+		switch (pattern) {
+		case key_pattern::zipf:
+			ss << u8"zipf(" << theta << u8")";
+			break;
+		case key_pattern::hotspot:
+			ss << u8"hotspot(" << hot_fraction << u8"/" << hot_probability << u8")";
+			break;
+		case key_pattern::sequential:
+			ss << u8"sequential";
+			break;
+		default:
+			ss << u8"uniform";
+		}
+		return ss.str();
+	}
+
+	int operator()(xoshiro256ss& engine) {
+		switch (pattern) {
+		case key_pattern::zipf: {
+			double u = engine.next_double();
+			double uz = u * zetan;
+			std::uint64_t rank;
+			if (uz < 1.0) {
+				rank = 0;
+			} else if (uz < 1.0 + std::pow(0.5, theta)) {
+				rank = 1;
+			} else {
+				rank = static_cast<std::uint64_t>(range * std::pow(eta * u - eta + 1.0, alpha));
+			}
+			return scramble(rank < static_cast<std::uint64_t>(range) ? rank : range - 1);
+		}
+		case key_pattern::hotspot: {
+			std::uint64_t hot = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(range * hot_fraction));
+			std::uint64_t x = engine();
+			if (engine.next_double() < hot_probability || hot == static_cast<std::uint64_t>(range)) {
+				return scramble(x % hot);
+			}
+			return scramble(hot + x % (range - hot));
+		}
+		case key_pattern::sequential: {
+			int key = static_cast<int>(next);
+			next = (next + 1) % range;
+			return key;
+		}
+		default:
+			return static_cast<int>(engine() % range);
+		}
+	}
+};
+
+enum class output_format {text, csv, json};
+
+/* how long and how often to measure, and how to print the results */
+struct benchmark_config {
+	/* operations before the measurement starts, not counted */
+	double warmup_seconds = 0.0;
+	double measure_seconds = 5.0;
+	int repetitions = 1;
+	output_format format = output_format::text;
+};
+
+/* keeps the compiler from dropping a computation whose result is unused,
+ * such as a count() in a read-only workload
+ */
+template<typename T>
+inline void keep_result(const T& value) {
+	volatile T sink = value;
+	(void)sink;
+}
+
+static const int BENCHMARK_CACHE_LINE_SIZE = 64;
+
+/* phases of a benchmark run: the workers wait, warm up and then measure
+ * rounds 0 .. repetitions-1; the phase after the last round ends the run
+ */
+static const int PHASE_WAIT = -2;
+static const int PHASE_WARMUP = -1;
+
+/* the results of one worker, one per cache line so the workers don't
+ * share one when they write them
+ */
+struct alignas(BENCHMARK_CACHE_LINE_SIZE) worker_result {
+	std::vector<double> ops_per_ms;
+};
+
+/* template is used to allow functions/functors of any signature;
+ * fun is called with a random number in [0, 2^31) and a key from keys
+ */
 template<typename Function>
-void worker(unsigned int random_seed, double& ops_per_sec, std::atomic<worker_status>* status, Function fun) {
+void worker(unsigned int random_seed, key_distribution keys, int repetitions, worker_result& result, std::atomic<int>* phase, Function fun) {
 	/* set up random number generator */
-	std::mt19937 engine(random_seed);
-	std::uniform_int_distribution<int> uniform_dist(RANDOM_VALUE_RANGE_MIN, RANDOM_VALUE_RANGE_MAX);
+	xoshiro256ss engine(random_seed);
 	/* for time measurements */
-	typedef std::chrono::high_resolution_clock clock;
+	typedef std::chrono::steady_clock clock;
+	std::vector<double> ops_per_ms(repetitions, 0.0);
 	/* wait for everyone to be allowed to start */
-	while(*status == worker_status::wait);
-	std::chrono::time_point<clock> start_time = clock::now();
-	long items = 0;
-	while(*status == worker_status::work) {
-		auto random = uniform_dist(engine);
-		/* do specified work */
-		fun(random);
-		items++;
-	}
-	std::chrono::time_point<clock> end_time = clock::now();
-	double time = std::chrono::duration<double, std::ratio<1, 1000>>(end_time - start_time).count();
-	ops_per_sec = items / time;
-	std::this_thread::sleep_for(std::chrono::seconds(1));	
-	return;
+	int current;
+	while((current = phase->load()) == PHASE_WAIT);
+	while((current = phase->load(std::memory_order_relaxed)) == PHASE_WARMUP) {
+		fun(engine.next_int(), keys(engine));
+	}
+	while(current < repetitions) {
+		std::chrono::time_point<clock> start_time = clock::now();
+		long items = 0;
+		int next;
+		while((next = phase->load(std::memory_order_relaxed)) == current) {
+			auto random = engine.next_int();
+			auto key = keys(engine);
+			/* do specified work */
+			fun(random, key);
+			items++;
+		}
+		std::chrono::time_point<clock> end_time = clock::now();
+		double time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+		ops_per_ms[current] = items / time;
+		current = next;
+	}
+	result.ops_per_ms = ops_per_ms;
 }
 
+/* one line per benchmark: text for reading, CSV (with a header line before
+ * the first) or JSON (one object per line) for scripts
+ */
+inline void print_result(const benchmark_config& config, const std::string& identifier, int threadcnt, const std::string& keys, std::vector<double> totals) {
+	std::vector<double> sorted = totals;
+	std::sort(sorted.begin(), sorted.end());
+	std::size_t n = sorted.size();
+	double median = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+	double min = sorted.front();
+	double max = sorted.back();
+	switch(config.format) {
+	case output_format::csv: {
+		static bool header = false;
+		if(!header) {
+			std::cout << u8"benchmark,threads,keys,repetitions,kops_median,kops_min,kops_max\n";
+			header = true;
+		}
+		std::cout << '"' << identifier << u8"\"," << threadcnt << u8",\"" << keys << u8"\"," << n << ','
+		          << std::fixed << median << ',' << min << ',' << max << "\n";
+		break;
+	}
+	case output_format::json:
+		std::cout << u8"{\"benchmark\": \"" << identifier << u8"\", \"threads\": " << threadcnt
+		          << u8", \"keys\": \"" << keys << u8"\", \"repetitions\": " << n << std::fixed
+		          << u8", \"kops_median\": " << median << u8", \"kops_min\": " << min << u8", \"kops_max\": " << max
+		          << u8", \"kops\": [";
+		for(std::size_t i = 0; i < n; i++) {
+			std::cout << (i > 0 ? u8", " : u8"") << totals[i];
+		}
+		std::cout << u8"]}\n";
+		break;
+	default:
+		std::cout << identifier << u8" / threads: " << threadcnt << u8" - thousands of operations per second: " << std::fixed << median;
+		if(n > 1) {
+			std::cout << u8" (median of " << n << u8", min " << min << u8", max " << max << u8")";
+		}
+		std::cout << "\n";
+	}
+	std::cout.flush();
+}
 
+/* fun(random, key) with the keys drawn from keys */
 template<typename Function>
-void benchmark(int threadcnt, std::string identifier, Function fun) {
-	/* initialize worker status */
-	std::atomic<worker_status> status;
-	status = worker_status::wait;
+void benchmark(int threadcnt, std::string identifier, const key_distribution& keys, Function fun, const benchmark_config& config = benchmark_config()) {
+	/* initialize worker phase */
+	std::atomic<int> phase{PHASE_WAIT};
 
 	/* spawn workers */
-	std::vector<double> ops_per_second(threadcnt);
-	std::vector<std::thread*> workers;
+	std::vector<worker_result> results(threadcnt);
+	std::vector<std::thread> workers;
 	std::random_device rd;
 	for(int i = 0; i < threadcnt; i++) {
 		auto seed = rd();
-		auto& result = ops_per_second[i];
-		auto w = new std::thread([seed, &result, &status, fun]() { worker(seed, result, &status, fun); });
-		workers.push_back(w);
+		auto& result = results[i];
+		key_distribution own_keys = keys;
+		own_keys.start_worker(i, threadcnt);
+		int repetitions = config.repetitions;
+		workers.emplace_back([seed, own_keys, repetitions, &result, &phase, fun]() { worker(seed, own_keys, repetitions, result, &phase, fun); });
 	};
 
-	/* start work for 5s */
-	status = worker_status::work;
-	std::this_thread::sleep_for(std::chrono::seconds(5));
-	status = worker_status::finish;
+	/* warm up, then measure each round for measure_seconds */
+	typedef std::chrono::duration<double> seconds;
+	if(config.warmup_seconds > 0) {
+		phase = PHASE_WARMUP;
+		std::this_thread::sleep_for(seconds(config.warmup_seconds));
+	}
+	for(int round = 0; round < config.repetitions; round++) {
+		phase = round;
+		std::this_thread::sleep_for(seconds(config.measure_seconds));
+	}
+	phase = config.repetitions;
 
 	/* make sure all workers terminated */
 	for(auto& w : workers) {
-		w->join();
-		delete w;
+		w.join();
 	}
-	workers.clear();
 
-	/* compute sum of partial results */
-	double result = 0.0;
-	for(auto& v : ops_per_second) {
-		result += v;
+	/* compute sum of partial results of each round */
+	std::vector<double> totals(config.repetitions, 0.0);
+	for(auto& r : results) {
+		for(int round = 0; round < config.repetitions; round++) {
+			totals[round] += r.ops_per_ms[round];
+		}
 	}
-	std::cout << identifier << u8" / threads: " << threadcnt << u8" - thousands of operations per second: " << std::fixed << result << "\n";
+	print_result(config, identifier, threadcnt, keys.name(), totals);
+}
+
+/* fun(random) with random uniformly in [RANDOM_VALUE_RANGE_MIN, RANDOM_VALUE_RANGE_MAX] */
+template<typename Function>
+void benchmark(int threadcnt, std::string identifier, Function fun) {
+	benchmark(threadcnt, identifier, key_distribution::uniform(RANDOM_VALUE_RANGE_MAX - RANDOM_VALUE_RANGE_MIN + 1), [fun](int, int key) {
+		fun(RANDOM_VALUE_RANGE_MIN + key);
+	});
 }
 
 #endif // lacpp_benchmark_hpp
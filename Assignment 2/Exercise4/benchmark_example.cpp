@@ -1,87 +1,276 @@
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "benchmark.hpp"
+#include "cohort_locks.hpp"
+#include "locks.hpp"
+#include "rw_locks.hpp"
+
+/* all list variants define sorted_list, so pick one at compile time:
+ * -DSORTED_LIST_CGLM (coarse-grained, benchmarked with every lock in locks.hpp),
+ * -DSORTED_LIST_RWLM (coarse-grained reader-writer, with every lock in rw_locks.hpp),
+ * -DSORTED_LIST_FGLM (fine-grained lock coupling, with TTAS and std::mutex node locks)
+ * -DSORTED_LIST_OLC (optimistic lock coupling, lock-free reads)
+ * -DSORTED_LIST_FC (flat combining)
+ * -DSORTED_LIST_UNROLLED_CGLM, -DSORTED_LIST_UNROLLED_FGLM (unrolled, coarse- or fine-grained)
+ * -DSORTED_LIST_RLE (one node per value with its multiplicity, with every lock in rw_locks.hpp)
+ * -DSORTED_LIST_LOCKFREE (Harris' lock-free list)
+ * or the default, the coarse-grained TATAS list
+ */
+#if defined(SORTED_LIST_CGLM)
+#include "sorted_list_cglm.hpp"
+#elif defined(SORTED_LIST_RWLM)
+#include "sorted_list_rwlm.hpp"
+#elif defined(SORTED_LIST_FGLM)
+#include "sorted_list_fglm.hpp"
+#elif defined(SORTED_LIST_OLC)
+#include "sorted_list_olc.hpp"
+#elif defined(SORTED_LIST_FC)
+#include "sorted_list_fc.hpp"
+#elif defined(SORTED_LIST_UNROLLED_CGLM)
+#include "sorted_list_unrolled_cglm.hpp"
+#elif defined(SORTED_LIST_UNROLLED_FGLM)
+#include "sorted_list_unrolled_fglm.hpp"
+#elif defined(SORTED_LIST_RLE)
+#include "sorted_list_rle.hpp"
+#elif defined(SORTED_LIST_LOCKFREE)
+#include "sorted_list_lockfree.hpp"
+#else
 #include "sorted_list_cgtatas.hpp"
+#endif
 
-static const int DATA_VALUE_RANGE_MIN = 0;
-static const int DATA_VALUE_RANGE_MAX = 256;
+static const int DATA_VALUE_RANGE = 256;
 static const int DATA_PREFILL = 512;
+static const int DATA_BATCH = 64;
 
 template<typename List>
-void read(List& l, int random) {
+void read(List& l, int, int key) {
 	/* read operations: 100% count */
-	l.count(random % DATA_VALUE_RANGE_MAX);
+	keep_result(l.count(key));
 }
 
 template<typename List>
-void update(List& l, int random) {
+void update(List& l, int random, int key) {
 	/* update operations: 50% insert, 50% remove */
-	auto choice = (random % (2*DATA_VALUE_RANGE_MAX))/DATA_VALUE_RANGE_MAX;
+	auto choice = random % 2;
 	if(choice == 0) {
-		l.insert(random % DATA_VALUE_RANGE_MAX);
+		l.insert(key);
 	} else {
-		l.remove(random % DATA_VALUE_RANGE_MAX);
+		l.remove(key);
 	}
 }
 
 template<typename List>
-void mixed(List& l, int random) {
+void mixed(List& l, int random, int key) {
 	/* mixed operations: 6.25% update, 93.75% count */
-	auto choice = (random % (32*DATA_VALUE_RANGE_MAX))/DATA_VALUE_RANGE_MAX;
+	auto choice = random % 32;
 	if(choice == 0) {
-		l.insert(random % DATA_VALUE_RANGE_MAX);
+		l.insert(key);
 	} else if(choice == 1) {
-		l.remove(random % DATA_VALUE_RANGE_MAX);
+		l.remove(key);
 	} else {
-		l.count(random % DATA_VALUE_RANGE_MAX);
+		keep_result(l.count(key));
 	}
 }
 
-int main(int argc, char* argv[]) {
-	/* get number of threads from command line */
-	if(argc < 2) {
-		std::cerr << u8"Please specify number of worker threads: " << argv[0] << u8" <number>\n";
-		std::exit(EXIT_FAILURE);
+template<typename List>
+void batch(List& l, int random, key_distribution& keys) {
+	/* batch operations: insert DATA_BATCH values in one insert_batch, then remove them in one remove_batch */
+	std::vector<int> values(DATA_BATCH);
+	xoshiro256ss engine(random);
+	for(auto& v : values) {
+		v = keys(engine);
 	}
-	std::istringstream ss(argv[1]);
-	int threadcnt;
-	if (!(ss >> threadcnt)) {
-		std::cerr << u8"Invalid number of threads '" << argv[1] << u8"'\n";
-		std::exit(EXIT_FAILURE);
+	l.insert_batch(values);
+	l.remove_batch(values);
+}
+
+/* what the lists are benchmarked with */
+struct workload_config {
+	key_distribution keys;
+	int prefill;
+	benchmark_config bench;
+};
+
+/* prefill list with keys from the distribution: inserted largest first,
+ * each insert stops at the front, so even a million take no time
+ */
+template<typename List>
+void prefill(List& l, const workload_config& config) {
+	key_distribution keys = config.keys;
+	xoshiro256ss engine(std::random_device{}());
+	std::vector<int> values(config.prefill);
+	for(auto& v : values) {
+		v = keys(engine);
+	}
+	std::sort(values.begin(), values.end(), std::greater<int>());
+	for(int v : values) {
+		l.insert(v);
 	}
-	/* set up random number generator */
-	std::random_device rd;
-	std::mt19937 engine(rd());
-	std::uniform_int_distribution<int> uniform_dist(DATA_VALUE_RANGE_MIN, DATA_VALUE_RANGE_MAX);
+}
 
-	/* example use of benchmarking */
+/* read, update and mixed benchmarks on one list type */
+template<typename List>
+void run(int threadcnt, std::string name, const workload_config& config) {
 	{
-		sorted_list<int> l1;
-		/* prefill list with 1024 elements */
-		for(int i = 0; i < DATA_PREFILL; i++) {
-			l1.insert(uniform_dist(engine));
-		}
-		benchmark(threadcnt, u8"non-thread-safe read", [&l1](int random){
-			read(l1, random);
-		});
-		benchmark(threadcnt, u8"non-thread-safe update", [&l1](int random){
-			update(l1, random);
-		});
+		List l1;
+		prefill(l1, config);
+		benchmark(threadcnt, name + u8" read", config.keys, [&l1](int random, int key){
+			read(l1, random, key);
+		}, config.bench);
+		benchmark(threadcnt, name + u8" update", config.keys, [&l1](int random, int key){
+			update(l1, random, key);
+		}, config.bench);
 	}
 	{
 		/* start with fresh list: update test left list in random size */
-		sorted_list<int> l1;
-		/* prefill list with 1024 elements */
-		for(int i = 0; i < DATA_PREFILL; i++) {
-			l1.insert(uniform_dist(engine));
+		List l1;
+		prefill(l1, config);
+		benchmark(threadcnt, name + u8" mixed", config.keys, [&l1](int random, int key){
+			mixed(l1, random, key);
+		}, config.bench);
+	}
+}
+
+/* batch benchmark, for the lists that have insert_batch and remove_batch */
+template<typename List>
+void run_batch(int threadcnt, std::string name, const workload_config& config) {
+	List l1;
+	prefill(l1, config);
+	/* the values of a batch follow the key distribution as well; every
+	 * worker runs its own copy of the lambda, and so of keys
+	 */
+	benchmark(threadcnt, name + u8" batch", config.keys, [&l1, keys = config.keys](int random, int) mutable {
+		batch(l1, random, keys);
+	}, config.bench);
+}
+
+static void usage(const char* program) {
+	std::cerr << u8"Usage: " << program << u8" <threads> [uniform|zipf|hotspot|sequential [key range [prefill]]] [options]\n"
+	          << u8"  --warmup <s>       operations before measuring (default: 0)\n"
+	          << u8"  --time <s>         length of one measurement (default: 5)\n"
+	          << u8"  --repetitions <n>  measurements per benchmark, reported as median/min/max (default: 1)\n"
+	          << u8"  --format <f>       text, csv or json (one object per line) (default: text)\n";
+	std::exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[]) {
+	/* split the command line into options and positional arguments */
+	std::vector<std::string> args;
+	benchmark_config bench;
+	for(int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if(arg.compare(0, 2, u8"--") != 0) {
+			args.push_back(arg);
+			continue;
+		}
+		if(i + 1 == argc) {
+			usage(argv[0]);
 		}
-		benchmark(threadcnt, u8"non-thread-safe mixed", [&l1](int random){
-			mixed(l1, random);
-		});
+		std::istringstream value(argv[++i]);
+		std::string format;
+		bool ok;
+		if(arg == u8"--warmup") {
+			ok = (value >> bench.warmup_seconds) && bench.warmup_seconds >= 0;
+		} else if(arg == u8"--time") {
+			ok = (value >> bench.measure_seconds) && bench.measure_seconds > 0;
+		} else if(arg == u8"--repetitions") {
+			ok = (value >> bench.repetitions) && bench.repetitions > 0;
+		} else if(arg == u8"--format" && (value >> format)) {
+			ok = true;
+			if(format == u8"csv") {
+				bench.format = output_format::csv;
+			} else if(format == u8"json") {
+				bench.format = output_format::json;
+			} else {
+				ok = format == u8"text";
+			}
+		} else {
+			ok = false;
+		}
+		if(!ok) {
+			std::cerr << u8"Invalid option " << arg << u8" " << argv[i] << u8"\n";
+			usage(argv[0]);
+		}
+	}
+
+	/* get number of threads from command line */
+	if(args.empty()) {
+		std::cerr << u8"Please specify number of worker threads\n";
+		usage(argv[0]);
 	}
+	std::istringstream ss(args[0]);
+	int threadcnt;
+	if (!(ss >> threadcnt)) {
+		std::cerr << u8"Invalid number of threads '" << args[0] << u8"'\n";
+		std::exit(EXIT_FAILURE);
+	}
+	/* optional: key distribution, key range and prefill */
+	std::string pattern = args.size() > 1 ? args[1] : u8"uniform";
+	int range = DATA_VALUE_RANGE;
+	int prefill_size = DATA_PREFILL;
+	if((args.size() > 2 && !(std::istringstream(args[2]) >> range)) || range < 1
+	   || (args.size() > 3 && !(std::istringstream(args[3]) >> prefill_size)) || prefill_size < 0) {
+		std::cerr << u8"Invalid key range or prefill size\n";
+		std::exit(EXIT_FAILURE);
+	}
+	workload_config config{key_distribution::uniform(range), prefill_size, bench};
+	if(pattern == u8"zipf") {
+		config.keys = key_distribution::zipf(range);
+	} else if(pattern == u8"hotspot") {
+		config.keys = key_distribution::hotspot(range);
+	} else if(pattern == u8"sequential") {
+		config.keys = key_distribution::sequential(range);
+	} else if(pattern != u8"uniform") {
+		std::cerr << u8"Unknown key distribution '" << pattern << u8"' (uniform, zipf, hotspot or sequential)\n";
+		std::exit(EXIT_FAILURE);
+	}
+	if(bench.format == output_format::text) {
+		std::cout << u8"keys: " << config.keys.name() << u8" over " << range << u8", prefill: " << prefill_size << "\n";
+	}
+
+#if defined(SORTED_LIST_CGLM)
+	run<sorted_list<int, std::mutex>>(threadcnt, u8"std::mutex", config);
+	run_batch<sorted_list<int, std::mutex>>(threadcnt, u8"std::mutex", config);
+	run<sorted_list<int, tas_lock>>(threadcnt, u8"tas", config);
+	run<sorted_list<int, ttas_lock>>(threadcnt, u8"ttas+backoff", config);
+	run<sorted_list<int, ticket_lock>>(threadcnt, u8"ticket", config);
+	run<sorted_list<int, mcs_lock>>(threadcnt, u8"mcs", config);
+	run<sorted_list<int, clh_lock>>(threadcnt, u8"clh", config);
+	run<sorted_list<int, spin_then_park_lock>>(threadcnt, u8"spin-then-park", config);
+	run<sorted_list<int, c_tkt_tkt_lock>>(threadcnt, u8"c-tkt-tkt", config);
+	run<sorted_list<int, c_mcs_mcs_lock>>(threadcnt, u8"c-mcs-mcs", config);
+#elif defined(SORTED_LIST_RWLM)
+	run<sorted_list<int, std::shared_mutex>>(threadcnt, u8"std::shared_mutex", config);
+	run<sorted_list<int, phase_fair_rw_lock>>(threadcnt, u8"phase-fair", config);
+	run<sorted_list<int, bravo_rw_lock<>>>(threadcnt, u8"bravo", config);
+#elif defined(SORTED_LIST_RLE)
+	run<sorted_list<int, std::shared_mutex>>(threadcnt, u8"rle std::shared_mutex", config);
+	run<sorted_list<int, phase_fair_rw_lock>>(threadcnt, u8"rle phase-fair", config);
+	run<sorted_list<int, bravo_rw_lock<>>>(threadcnt, u8"rle bravo", config);
+#elif defined(SORTED_LIST_UNROLLED_CGLM)
+	run<sorted_list<int, std::mutex>>(threadcnt, u8"unrolled std::mutex", config);
+	run<sorted_list<int, ttas_lock>>(threadcnt, u8"unrolled ttas+backoff", config);
+#elif defined(SORTED_LIST_FGLM)
+	run<sorted_list<int, ttas_lock>>(threadcnt, u8"lock coupling ttas", config);
+	run_batch<sorted_list<int, ttas_lock>>(threadcnt, u8"lock coupling ttas", config);
+	run<sorted_list<int, std::mutex>>(threadcnt, u8"lock coupling std::mutex", config);
+#elif defined(SORTED_LIST_UNROLLED_FGLM)
+	run<sorted_list<int>>(threadcnt, u8"unrolled lock coupling", config);
+#elif defined(SORTED_LIST_OLC)
+	run<sorted_list<int>>(threadcnt, u8"olc", config);
+#elif defined(SORTED_LIST_FC)
+	run<sorted_list<int>>(threadcnt, u8"flat combining", config);
+#elif defined(SORTED_LIST_LOCKFREE)
+	run<sorted_list<int>>(threadcnt, u8"lock-free", config);
+#else
+	run<sorted_list<int>>(threadcnt, u8"tatas", config);
+#endif
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,192 @@
+#ifndef lacpp_cohort_locks_hpp
+#define lacpp_cohort_locks_hpp lacpp_cohort_locks_hpp
+
+/* NUMA-aware cohort locks (Dice, Marathe & Shavit, 2012).
+ * Every NUMA node has a local lock, and one global lock decides which node
+ * owns the whole lock. A thread that releases while a thread of its own node
+ * waits hands it over locally and keeps the global lock, so the lock and the
+ * data it protects stay in one node's caches. After MAX_PASSES local handovers
+ * the global lock is released anyway, so other nodes are not starved.
+ *
+ * The global lock may be released by another thread of the cohort than the one
+ * that took it, which ticket_lock and mcs_lock allow (mcs_lock keeps the
+ * holder's node in the lock, not in the thread).
+ *
+ * On a machine with one NUMA node (or where the topology can't be read) the
+ * cohort lock is a plain mcs_lock.
+ */
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "locks.hpp"
+
+/* NUMA topology from /sys/devices/system/node: the online nodes and the cpus of each */
+class numa_topology {
+	int nodes = 1;
+	std::vector<int> cpu_to_node;
+
+	/* parses lists like "0-3,8-11" */
+	static std::vector<int> parse_list(const std::string& list) {
+		std::vector<int> values;
+		std::istringstream ss(list);
+		std::string range;
+		while (std::getline(ss, range, ',')) {
+			if (range.empty() || range == "\n") {
+				continue;
+			}
+			std::size_t dash = range.find('-');
+			int first = std::stoi(range.substr(0, dash));
+			int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+			for (int i = first; i <= last; i++) {
+				values.push_back(i);
+			}
+		}
+		return values;
+	}
+
+	static bool read_line(const std::string& path, std::string& line) {
+		std::ifstream file(path);
+		return static_cast<bool>(std::getline(file, line));
+	}
+
+	numa_topology() {
+		std::string line;
+		if (!read_line("/sys/devices/system/node/online", line)) {
+			return;
+		}
+		std::vector<int> online = parse_list(line);
+		int index = 0;
+		for (int node : online) {
+			if (!read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", line)) {
+				continue;
+			}
+			for (int cpu : parse_list(line)) {
+				if (cpu >= static_cast<int>(cpu_to_node.size())) {
+					cpu_to_node.resize(cpu + 1, 0);
+				}
+				cpu_to_node[cpu] = index;
+			}
+			index++;
+		}
+		if (index > 0) {
+			nodes = index;
+		}
+	}
+
+public:
+	static const numa_topology& get() {
+		static numa_topology topology;
+		return topology;
+	}
+
+	/* number of NUMA nodes, numbered 0..node_count()-1 */
+	int node_count() const {
+		return nodes;
+	}
+
+	/* the node of the cpu the calling thread runs on now */
+	int current_node() const {
+#ifdef __linux__
+		int cpu = sched_getcpu();
+		if (cpu >= 0 && cpu < static_cast<int>(cpu_to_node.size())) {
+			return cpu_to_node[cpu];
+		}
+#endif
+		return 0;
+	}
+};
+
+/* Global and Local are ticket_lock or mcs_lock; Local needs has_waiters() */
+template<typename Global, typename Local>
+class cohort_lock {
+	static const int MAX_PASSES = 64;
+
+	struct alignas(CACHE_LINE_SIZE) cohort {
+		Local lock;
+		/* both only accessed while holding lock */
+		bool owns_global = false;
+		int passes = 0;
+	};
+
+	Global global;
+	std::unique_ptr<cohort[]> cohorts;
+	int cohort_count;
+	/* the cohort of the current holder, written while holding the lock */
+	int holder = 0;
+	mcs_lock single;
+
+	void acquired(int node) {
+		cohort& c = cohorts[node];
+		if (!c.owns_global) {
+			global.lock();
+			c.owns_global = true;
+		}
+		holder = node;
+	}
+
+public:
+	cohort_lock()
+		: cohorts(new cohort[numa_topology::get().node_count()]),
+		  cohort_count(numa_topology::get().node_count()) {}
+
+	void lock() {
+		if (cohort_count == 1) {
+			single.lock();
+			return;
+		}
+		int node = numa_topology::get().current_node();
+		cohorts[node].lock.lock();
+		acquired(node);
+	}
+
+	bool try_lock() {
+		if (cohort_count == 1) {
+			return single.try_lock();
+		}
+		int node = numa_topology::get().current_node();
+		cohort& c = cohorts[node];
+		if (!c.lock.try_lock()) {
+			return false;
+		}
+		if (!c.owns_global) {
+			if (!global.try_lock()) {
+				c.lock.unlock();
+				return false;
+			}
+			c.owns_global = true;
+		}
+		holder = node;
+		return true;
+	}
+
+	void unlock() {
+		if (cohort_count == 1) {
+			single.unlock();
+			return;
+		}
+		cohort& c = cohorts[holder];
+		if (c.passes < MAX_PASSES && c.lock.has_waiters()) {
+			/* hand over within the node, keeping the global lock */
+			c.passes++;
+		} else {
+			c.passes = 0;
+			c.owns_global = false;
+			global.unlock();
+		}
+		c.lock.unlock();
+	}
+};
+
+/* C-TKT-TKT: ticket locks globally and per node */
+typedef cohort_lock<ticket_lock, ticket_lock> c_tkt_tkt_lock;
+/* C-MCS-MCS: MCS locks globally and per node */
+typedef cohort_lock<mcs_lock, mcs_lock> c_mcs_mcs_lock;
+
+#endif // lacpp_cohort_locks_hpp
@@ -0,0 +1,201 @@
+#ifndef lacpp_epoch_reclamation_hpp
+#define lacpp_epoch_reclamation_hpp lacpp_epoch_reclamation_hpp
+
+/* epoch-based memory reclamation (Fraser, 2004) for lock-free structures:
+ * a node that has been unlinked may still be read by threads that found it
+ * before, so it is only retired, and freed once every thread has been seen
+ * outside of an operation since then.
+ *
+ * Every operation on the structure runs inside an epoch_guard. A guard
+ * announces the global epoch in the thread's slot; the epoch only advances
+ * when every thread inside a guard has announced the current one. Nodes
+ * retired in epoch e are freed once the global epoch is e + 2, when no guard
+ * from epoch e can be left. A thread that stalls inside a guard holds back
+ * all reclamation (but never the other threads' operations).
+ */
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "locks.hpp"
+
+class epoch_reclamation {
+	static const int SLOTS = 256;
+	/* retire calls between attempts to advance the epoch */
+	static const int ADVANCE_EVERY = 64;
+
+	struct retired {
+		void* pointer;
+		void (*deleter)(void*);
+
+		void free() const {
+			deleter(pointer);
+		}
+	};
+
+	/* (epoch << 1) | 1 while the owner is inside a guard, 0 outside */
+	struct alignas(CACHE_LINE_SIZE) slot {
+		std::atomic<unsigned> state{0};
+		std::atomic<bool> claimed{false};
+	};
+
+	/* retired nodes of one epoch */
+	struct bag {
+		unsigned epoch = 0;
+		std::vector<retired> nodes;
+
+		void free() {
+			for (const retired& r : nodes) {
+				r.free();
+			}
+			nodes.clear();
+		}
+	};
+
+	/* per-thread state: the slot and a bag for each of the last three epochs */
+	struct participant {
+		slot* own;
+		bag bags[3];
+		int retires = 0;
+		int depth = 0;
+
+		participant() : own(claim()) {}
+
+		~participant() {
+			own->state.store(0, std::memory_order_release);
+			own->claimed.store(false, std::memory_order_release);
+			/* leave what can't be freed yet to the threads that are still running */
+			std::lock_guard<std::mutex> lock(globals().orphans_mutex);
+			for (bag& b : bags) {
+				if (!b.nodes.empty()) {
+					globals().orphans.push_back(std::move(b));
+				}
+			}
+		}
+	};
+
+	struct global_state {
+		std::atomic<unsigned> epoch{0};
+		slot slots[SLOTS];
+		/* slots[0..used) have been claimed at some point */
+		std::atomic<int> used{0};
+		std::mutex orphans_mutex;
+		std::vector<bag> orphans;
+
+		~global_state() {
+			for (bag& b : orphans) {
+				b.free();
+			}
+		}
+	};
+
+	static global_state& globals() {
+		static global_state state;
+		return state;
+	}
+
+	static participant& local() {
+		static thread_local participant me;
+		return me;
+	}
+
+	static slot* claim() {
+		global_state& g = globals();
+		while (true) {
+			for (int i = 0; i < SLOTS; i++) {
+				bool expected = false;
+				if (!g.slots[i].claimed.load(std::memory_order_relaxed)
+				    && g.slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					int n = g.used.load(std::memory_order_relaxed);
+					while (n <= i && !g.used.compare_exchange_weak(n, i + 1)) {
+						/* n is reloaded by the failed exchange */
+					}
+					return &g.slots[i];
+				}
+			}
+			/* more threads than slots: wait for one to exit */
+			std::this_thread::yield();
+		}
+	}
+
+	/* advance the global epoch if every thread inside a guard has seen it */
+	static void try_advance() {
+		global_state& g = globals();
+		unsigned epoch = g.epoch.load();
+		int n = g.used.load(std::memory_order_acquire);
+		for (int i = 0; i < n; i++) {
+			unsigned state = g.slots[i].state.load();
+			if ((state & 1) && (state >> 1) != epoch) {
+				return;
+			}
+		}
+		if (!g.epoch.compare_exchange_strong(epoch, epoch + 1)) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(g.orphans_mutex, std::try_to_lock);
+		if (!lock.owns_lock()) {
+			return;
+		}
+		for (auto b = g.orphans.begin(); b != g.orphans.end();) {
+			if (epoch + 1 - b->epoch >= 2) {
+				b->free();
+				b = g.orphans.erase(b);
+			} else {
+				++b;
+			}
+		}
+	}
+
+public:
+	/* keeps the nodes the calling thread can see from being freed */
+	class epoch_guard {
+	public:
+		epoch_guard() {
+			participant& me = local();
+			if (me.depth++ == 0) {
+				unsigned epoch = globals().epoch.load();
+				me.own->state.store((epoch << 1) | 1);
+				/* the loads of the structure's pointers that follow are only
+				 * acquire: keep them from moving before the announcement, so
+				 * that try_advance sees us before we can see any node
+				 */
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+		}
+
+		~epoch_guard() {
+			participant& me = local();
+			if (--me.depth == 0) {
+				me.own->state.store(0, std::memory_order_release);
+			}
+		}
+
+		epoch_guard(const epoch_guard&) = delete;
+		epoch_guard& operator=(const epoch_guard&) = delete;
+	};
+
+	/* free node (allocated with new) once no guard can see it any more;
+	 * the node must already be unlinked, and only one thread may retire it
+	 */
+	template<typename Node>
+	static void retire(Node* node) {
+		participant& me = local();
+		unsigned epoch = globals().epoch.load();
+		bag& b = me.bags[epoch % 3];
+		if (b.epoch != epoch) {
+			/* the bag is from epoch - 3 or earlier */
+			b.free();
+			b.epoch = epoch;
+		}
+		b.nodes.push_back(retired{node, [](void* p) { delete static_cast<Node*>(p); }});
+		if (++me.retires % ADVANCE_EVERY == 0) {
+			try_advance();
+		}
+	}
+};
+
+typedef epoch_reclamation::epoch_guard epoch_guard;
+
+#endif // lacpp_epoch_reclamation_hpp
@@ -0,0 +1,336 @@
+#ifndef lacpp_locks_hpp
+#define lacpp_locks_hpp lacpp_locks_hpp
+
+/* spin lock algorithms with the interface of std::mutex:
+ * lock(), unlock() and try_lock(), so they work with std::lock_guard
+ * and can be given to the lists and sets as their lock type.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+static const int CACHE_LINE_SIZE = 64;
+
+/* tell the core we are spinning (frees pipeline resources for the other hyperthread) */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/* test-and-set: every attempt is a write, so waiters keep stealing the cache line */
+class tas_lock {
+	std::atomic<bool> locked{false};
+
+public:
+	void lock() {
+		while (locked.exchange(true, std::memory_order_acquire)) {
+			cpu_relax();
+		}
+	}
+
+	bool try_lock() {
+		return !locked.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlock() {
+		locked.store(false, std::memory_order_release);
+	}
+};
+
+/* test-and-test-and-set: waiters spin on their cached copy and only try
+ * the exchange when the lock looks free; after a failed attempt they back
+ * off for an exponentially growing number of pauses
+ */
+class ttas_lock {
+	static const int MIN_BACKOFF = 4;
+	static const int MAX_BACKOFF = 1024;
+	std::atomic<bool> locked{false};
+
+public:
+	void lock() {
+		int backoff = MIN_BACKOFF;
+		while (true) {
+			while (locked.load(std::memory_order_relaxed)) {
+				cpu_relax();
+			}
+			if (!locked.exchange(true, std::memory_order_acquire)) {
+				return;
+			}
+			for (int i = 0; i < backoff; i++) {
+				cpu_relax();
+			}
+			if (backoff < MAX_BACKOFF) {
+				backoff *= 2;
+			}
+		}
+	}
+
+	bool try_lock() {
+		return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlock() {
+		locked.store(false, std::memory_order_release);
+	}
+};
+
+/* ticket lock: threads take a number and are served first come, first served */
+class ticket_lock {
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> next{0};
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> serving{0};
+
+public:
+	void lock() {
+		unsigned ticket = next.fetch_add(1, std::memory_order_relaxed);
+		while (serving.load(std::memory_order_acquire) != ticket) {
+			cpu_relax();
+		}
+	}
+
+	bool try_lock() {
+		unsigned ticket = serving.load(std::memory_order_acquire);
+		return next.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire);
+	}
+
+	void unlock() {
+		serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/* called by the holder: are other threads waiting? */
+	bool has_waiters() {
+		return next.load(std::memory_order_relaxed) - serving.load(std::memory_order_relaxed) > 1;
+	}
+};
+
+/* queue nodes for the MCS and CLH locks.
+ * A thread may hold many queue locks at once (e.g. hand-over-hand locking in
+ * a list), so nodes are not one per thread: every acquisition takes a node from
+ * a per-thread pool, and the lock remembers the holder's node for unlock().
+ * Nodes move between threads, and a stale pointer to one may still be read,
+ * so they are never freed while the program runs: a thread that exits hands
+ * its nodes to a shared spare list.
+ */
+template<typename Node>
+class node_pool {
+	std::vector<Node*> nodes;
+
+	static std::mutex& spare_mutex() {
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	static std::vector<Node*>& spare() {
+		static std::vector<Node*> nodes;
+		return nodes;
+	}
+
+public:
+	node_pool() = default;
+	node_pool(const node_pool&) = delete;
+	node_pool& operator=(const node_pool&) = delete;
+	~node_pool() {
+		std::lock_guard<std::mutex> lock(spare_mutex());
+		spare().insert(spare().end(), nodes.begin(), nodes.end());
+	}
+
+	static node_pool<Node>& local() {
+		static thread_local node_pool<Node> pool;
+		return pool;
+	}
+
+	Node* get() {
+		if (nodes.empty()) {
+			std::lock_guard<std::mutex> lock(spare_mutex());
+			if (spare().empty()) {
+				return new Node();
+			}
+			nodes.swap(spare());
+		}
+		Node* n = nodes.back();
+		nodes.pop_back();
+		return n;
+	}
+
+	void put(Node* n) {
+		nodes.push_back(n);
+	}
+};
+
+/* MCS lock: waiters form a linked queue and each spins on its own node,
+ * so a release only touches the cache line of the next waiter
+ */
+class mcs_lock {
+	struct alignas(CACHE_LINE_SIZE) qnode {
+		std::atomic<qnode*> next{nullptr};
+		std::atomic<bool> locked{false};
+	};
+
+	std::atomic<qnode*> tail{nullptr};
+	qnode* holder = nullptr;
+
+public:
+	void lock() {
+		qnode* me = node_pool<qnode>::local().get();
+		me->next.store(nullptr, std::memory_order_relaxed);
+		me->locked.store(true, std::memory_order_relaxed);
+		qnode* pred = tail.exchange(me, std::memory_order_acq_rel);
+		if (pred != nullptr) {
+			pred->next.store(me, std::memory_order_release);
+			while (me->locked.load(std::memory_order_acquire)) {
+				cpu_relax();
+			}
+		}
+		holder = me;
+	}
+
+	bool try_lock() {
+		qnode* me = node_pool<qnode>::local().get();
+		me->next.store(nullptr, std::memory_order_relaxed);
+		qnode* expected = nullptr;
+		if (tail.compare_exchange_strong(expected, me, std::memory_order_acq_rel)) {
+			holder = me;
+			return true;
+		}
+		node_pool<qnode>::local().put(me);
+		return false;
+	}
+
+	void unlock() {
+		qnode* me = holder;
+		qnode* succ = me->next.load(std::memory_order_acquire);
+		if (succ == nullptr) {
+			qnode* expected = me;
+			if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+				node_pool<qnode>::local().put(me);
+				return;
+			}
+			/* a successor is between its exchange on tail and linking itself in */
+			while ((succ = me->next.load(std::memory_order_acquire)) == nullptr) {
+				cpu_relax();
+			}
+		}
+		succ->locked.store(false, std::memory_order_release);
+		node_pool<qnode>::local().put(me);
+	}
+
+	/* called by the holder: are other threads waiting? */
+	bool has_waiters() {
+		return holder->next.load(std::memory_order_relaxed) != nullptr || tail.load(std::memory_order_relaxed) != holder;
+	}
+};
+
+/* CLH lock: an implicit queue, each waiter spins on its predecessor's node.
+ * On release a thread leaves its node to its successor and keeps the
+ * predecessor's node instead.
+ */
+class clh_lock {
+	struct alignas(CACHE_LINE_SIZE) qnode {
+		std::atomic<bool> locked{false};
+	};
+
+	std::atomic<qnode*> tail;
+	qnode* holder = nullptr;
+	qnode* holder_pred = nullptr;
+
+public:
+	clh_lock() : tail(new qnode()) {}
+	clh_lock(const clh_lock&) = delete;
+	clh_lock& operator=(const clh_lock&) = delete;
+	~clh_lock() {
+		delete tail.load();
+	}
+
+	void lock() {
+		qnode* me = node_pool<qnode>::local().get();
+		me->locked.store(true, std::memory_order_relaxed);
+		qnode* pred = tail.exchange(me, std::memory_order_acq_rel);
+		while (pred->locked.load(std::memory_order_acquire)) {
+			cpu_relax();
+		}
+		holder = me;
+		holder_pred = pred;
+	}
+
+	bool try_lock() {
+		qnode* pred = tail.load(std::memory_order_acquire);
+		if (pred->locked.load(std::memory_order_acquire)) {
+			return false;
+		}
+		qnode* me = node_pool<qnode>::local().get();
+		me->locked.store(true, std::memory_order_relaxed);
+		if (!tail.compare_exchange_strong(pred, me, std::memory_order_acq_rel)) {
+			node_pool<qnode>::local().put(me);
+			return false;
+		}
+		/* pred may have been recycled and locked again since we looked at it;
+		 * we are queued behind it now, so wait as lock() does
+		 */
+		while (pred->locked.load(std::memory_order_acquire)) {
+			cpu_relax();
+		}
+		holder = me;
+		holder_pred = pred;
+		return true;
+	}
+
+	void unlock() {
+		qnode* pred = holder_pred;
+		holder->locked.store(false, std::memory_order_release);
+		node_pool<qnode>::local().put(pred);
+	}
+};
+
+/* spin-then-park: spin for a while as a TTAS lock, then sleep on a
+ * condition variable, so long waits do not burn a core
+ */
+class spin_then_park_lock {
+	static const int SPINS = 1000;
+	std::atomic<bool> locked{false};
+	std::atomic<int> parked{0};
+	std::mutex mtx;
+	std::condition_variable cv;
+
+public:
+	void lock() {
+		for (int i = 0; i < SPINS; i++) {
+			if (try_lock()) {
+				return;
+			}
+			cpu_relax();
+		}
+		std::unique_lock<std::mutex> guard(mtx);
+		parked.fetch_add(1);
+		/* check with a sequentially consistent load (try_lock's is relaxed),
+		 * which pairs with the one in unlock()
+		 */
+		cv.wait(guard, [this] { return !locked.load() && !locked.exchange(true, std::memory_order_acquire); });
+		parked.fetch_sub(1);
+	}
+
+	bool try_lock() {
+		return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlock() {
+		/* sequentially consistent, so that either we see the parked thread
+		 * or it sees the lock free when it checks before sleeping
+		 */
+		locked.store(false);
+		if (parked.load() > 0) {
+			std::lock_guard<std::mutex> guard(mtx);
+			cv.notify_one();
+		}
+	}
+};
+
+#endif // lacpp_locks_hpp
@@ -0,0 +1,219 @@
+#ifndef lacpp_rw_locks_hpp
+#define lacpp_rw_locks_hpp lacpp_rw_locks_hpp
+
+/* reader-writer locks with the interface of std::shared_mutex:
+ * lock()/unlock()/try_lock() for writers and
+ * lock_shared()/unlock_shared()/try_lock_shared() for readers,
+ * so they work with std::unique_lock and std::shared_lock.
+ * std::shared_mutex itself is the baseline.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+
+#include "locks.hpp"
+
+/* phase-fair ticket lock (Brandenburg & Anderson, 2010): readers and writers
+ * take turns in phases, so neither side can starve the other. A writer waits
+ * at most one read phase, a reader at most one write phase.
+ *
+ * rin/rout count entering and leaving readers in steps of READER; the low bits
+ * of rin tell readers that a writer is present and which phase it is in.
+ * The phase alternates with every write phase that actually happens, so a
+ * reader that has not yet seen the end of one write phase is never caught by
+ * the next; a failed try_lock leaves it alone.
+ */
+class phase_fair_rw_lock {
+	static const unsigned READER = 0x100;
+	static const unsigned WRITER_BITS = 0x3;
+	static const unsigned PRESENT = 0x2;
+	static const unsigned PHASE = 0x1;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> rin{0};
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> rout{0};
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> win{0};
+	alignas(CACHE_LINE_SIZE) std::atomic<unsigned> wout{0};
+	/* the phase bit of the next write phase, only used by the writer that
+	 * holds the current ticket
+	 */
+	unsigned phase = 0;
+
+public:
+	void lock_shared() {
+		unsigned w = rin.fetch_add(READER, std::memory_order_acquire) & WRITER_BITS;
+		if (w != 0) {
+			/* wait for the current write phase to end */
+			while ((rin.load(std::memory_order_acquire) & WRITER_BITS) == w) {
+				cpu_relax();
+			}
+		}
+	}
+
+	bool try_lock_shared() {
+		unsigned r = rin.load(std::memory_order_relaxed);
+		return (r & WRITER_BITS) == 0 && rin.compare_exchange_strong(r, r + READER, std::memory_order_acquire);
+	}
+
+	void unlock_shared() {
+		rout.fetch_add(READER, std::memory_order_release);
+	}
+
+	void lock() {
+		unsigned ticket = win.fetch_add(1, std::memory_order_relaxed);
+		while (wout.load(std::memory_order_acquire) != ticket) {
+			cpu_relax();
+		}
+		/* block new readers, then wait for the ones already inside */
+		unsigned readers = rin.fetch_add(PRESENT | phase, std::memory_order_acquire);
+		while (rout.load(std::memory_order_acquire) != readers) {
+			cpu_relax();
+		}
+	}
+
+	bool try_lock() {
+		/* fail without taking a ticket while a writer or readers are inside */
+		unsigned ticket = wout.load(std::memory_order_acquire);
+		if (win.load(std::memory_order_relaxed) != ticket) {
+			return false;
+		}
+		unsigned readers = rin.load(std::memory_order_relaxed);
+		if (rout.load(std::memory_order_acquire) != readers
+		    || !win.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire)) {
+			return false;
+		}
+		/* a reader may have come in since: then give the ticket back, which
+		 * is harmless as no write phase was started
+		 */
+		if (!rin.compare_exchange_strong(readers, readers | PRESENT | phase, std::memory_order_acquire)) {
+			wout.fetch_add(1, std::memory_order_release);
+			return false;
+		}
+		return true;
+	}
+
+	void unlock() {
+		phase ^= PHASE;
+		rin.fetch_and(~WRITER_BITS, std::memory_order_release);
+		wout.fetch_add(1, std::memory_order_release);
+	}
+};
+
+/* BRAVO (Dice & Kogan, 2019) on top of another reader-writer lock.
+ * While the lock is read-biased, a reader only announces itself in its own
+ * slot and never touches a shared cache line. A writer revokes the bias,
+ * waits until the slots are empty and then uses the underlying lock, which
+ * readers fall back to meanwhile. The bias is restored once the reads since
+ * the revocation have paid for it (N times the time spent revoking).
+ *
+ * Threads are hashed to slots, so two threads may share one; the one that
+ * loses takes the slow path. A thread must not read-lock the same lock twice.
+ */
+template<typename RwLock = phase_fair_rw_lock>
+class bravo_rw_lock {
+	static const int SLOTS = 64;
+	static const int N = 9;
+
+	struct alignas(CACHE_LINE_SIZE) slot {
+		std::atomic<unsigned> owner{0};
+	};
+
+	static unsigned thread_token() {
+		static std::atomic<unsigned> next{1};
+		static thread_local unsigned token = next.fetch_add(1);
+		return token;
+	}
+
+	static long long now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	slot slots[SLOTS];
+	alignas(CACHE_LINE_SIZE) std::atomic<bool> read_bias{true};
+	std::atomic<long long> inhibit_until{0};
+	RwLock underlying;
+
+public:
+	void lock_shared() {
+		if (read_bias.load()) {
+			unsigned token = thread_token();
+			slot& s = slots[token % SLOTS];
+			unsigned expected = 0;
+			if (s.owner.compare_exchange_strong(expected, token)) {
+				/* sequentially consistent with the writer's revocation:
+				 * either it sees our slot, or we see the bias gone
+				 */
+				if (read_bias.load()) {
+					return;
+				}
+				s.owner.store(0, std::memory_order_release);
+			}
+		}
+		underlying.lock_shared();
+		if (!read_bias.load(std::memory_order_relaxed) && now() >= inhibit_until.load(std::memory_order_relaxed)) {
+			read_bias.store(true);
+		}
+	}
+
+	bool try_lock_shared() {
+		if (read_bias.load()) {
+			unsigned token = thread_token();
+			slot& s = slots[token % SLOTS];
+			unsigned expected = 0;
+			if (s.owner.compare_exchange_strong(expected, token)) {
+				if (read_bias.load()) {
+					return true;
+				}
+				s.owner.store(0, std::memory_order_release);
+			}
+		}
+		return underlying.try_lock_shared();
+	}
+
+	void unlock_shared() {
+		slot& s = slots[thread_token() % SLOTS];
+		if (s.owner.load(std::memory_order_relaxed) == thread_token()) {
+			s.owner.store(0, std::memory_order_release);
+		} else {
+			underlying.unlock_shared();
+		}
+	}
+
+	void lock() {
+		underlying.lock();
+		revoke();
+	}
+
+	bool try_lock() {
+		if (!underlying.try_lock()) {
+			return false;
+		}
+		revoke();
+		return true;
+	}
+
+	void unlock() {
+		underlying.unlock();
+	}
+
+private:
+	void revoke() {
+		if (!read_bias.load(std::memory_order_relaxed)) {
+			return;
+		}
+		read_bias.store(false);
+		long long start = now();
+		/* sequentially consistent, like the bias store above: an acquire
+		 * load could be ordered before it and miss a reader
+		 */
+		for (slot& s : slots) {
+			while (s.owner.load() != 0) {
+				cpu_relax();
+			}
+		}
+		long long end = now();
+		inhibit_until.store(end + (end - start) * N, std::memory_order_relaxed);
+	}
+};
+
+#endif // lacpp_rw_locks_hpp
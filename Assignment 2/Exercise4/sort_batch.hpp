@@ -0,0 +1,45 @@
+#ifndef lacpp_sort_batch_hpp
+#define lacpp_sort_batch_hpp lacpp_sort_batch_hpp
+
+/* sorting the values of a batch operation before it is merged into a list:
+ * large batches are cut into one chunk per hardware thread, the chunks are
+ * sorted in parallel and then merged
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+template<typename T>
+void sort_batch(std::vector<T>& values) {
+	/* below this, starting threads costs more than it saves */
+	static const std::size_t PARALLEL_THRESHOLD = 1 << 16;
+	std::size_t chunks = std::min<std::size_t>(std::thread::hardware_concurrency(), values.size() / (PARALLEL_THRESHOLD / 2));
+	if (values.size() < PARALLEL_THRESHOLD || chunks < 2) {
+		std::sort(values.begin(), values.end());
+		return;
+	}
+
+	std::vector<typename std::vector<T>::iterator> bounds;
+	for (std::size_t i = 0; i <= chunks; i++) {
+		bounds.push_back(values.begin() + values.size() * i / chunks);
+	}
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1; i < chunks; i++) {
+		workers.emplace_back([&bounds, i]() { std::sort(bounds[i], bounds[i + 1]); });
+	}
+	std::sort(bounds[0], bounds[1]);
+	for (auto& w : workers) {
+		w.join();
+	}
+
+	/* merge neighbouring runs, doubling their width each round */
+	for (std::size_t width = 1; width < chunks; width *= 2) {
+		for (std::size_t i = 0; i + width < chunks; i += 2 * width) {
+			std::inplace_merge(bounds[i], bounds[i + width], bounds[std::min(i + 2 * width, chunks)]);
+		}
+	}
+}
+
+#endif // lacpp_sort_batch_hpp
@@ -2,6 +2,9 @@
 #define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
 
 #include <mutex>
+#include <vector>
+
+#include "sort_batch.hpp"
 
 /* a sorted list implementation by David Klaftenegger, 2015
  * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
@@ -14,11 +17,13 @@ struct node {
 	node<T>* next;
 };
 
-/* non-concurrent sorted singly-linked list */
-template<typename T>
+/* sorted singly-linked list behind one coarse-grained lock;
+ * Lock can be std::mutex or any of the locks in locks.hpp
+ */
+template<typename T, typename Lock = std::mutex>
 class sorted_list {
 	node<T>* first = nullptr;
-	std::mutex mtx; //coarse-grained locking (for example, in C++, using the std::mutex class
+	Lock mtx; //coarse-grained locking (for example, in C++, using the std::mutex class
 
 public:
 	/* default implementations:
@@ -32,10 +37,10 @@ public:
 	 * which are explicitly listed due to the rule of five.
 	 */
 	sorted_list() = default;
-	sorted_list(const sorted_list<T>& other) = default;
-	sorted_list(sorted_list<T>&& other) = default;
-	sorted_list<T>& operator=(const sorted_list<T>& other) = default;
-	sorted_list<T>& operator=(sorted_list<T>&& other) = default;
+	sorted_list(const sorted_list& other) = default;
+	sorted_list(sorted_list&& other) = default;
+	sorted_list& operator=(const sorted_list& other) = default;
+	sorted_list& operator=(sorted_list&& other) = default;
 	~sorted_list() {
 		while (first != nullptr) {
 			remove(first->value);
@@ -44,7 +49,7 @@ public:
 	/* insert v into the list */
 	void insert(T v) {
 
-		std::lock_guard<std::mutex> lock(mtx);
+		std::lock_guard<Lock> lock(mtx);
 
 		/* first find position */
 		node<T>* pred = nullptr;
@@ -70,7 +75,7 @@ public:
 
 	void remove(T v) {
 
-		std::lock_guard<std::mutex> lock(mtx);
+		std::lock_guard<Lock> lock(mtx);
 
 		/* first find position */
 		node<T>* pred = nullptr;
@@ -93,10 +98,53 @@ public:
 		delete current;
 	}
 
+	/* insert all values in one pass over the list: the values are sorted
+	 * first, so each one goes after the previous one
+	 */
+	void insert_batch(std::vector<T> values) {
+		sort_batch(values);
+
+		std::lock_guard<Lock> lock(mtx);
+
+		/* link points at the pointer to the first node not below the current value */
+		node<T>** link = &first;
+		for (const T& v : values) {
+			while (*link != nullptr && (*link)->value < v) {
+				link = &(*link)->next;
+			}
+			node<T>* current = new node<T>();
+			current->value = v;
+			current->next = *link;
+			*link = current;
+			link = &current->next;
+		}
+	}
+
+	/* remove one copy of each value (as often as it is in values),
+	 * in one pass over the list like insert_batch
+	 */
+	void remove_batch(std::vector<T> values) {
+		sort_batch(values);
+
+		std::lock_guard<Lock> lock(mtx);
+
+		node<T>** link = &first;
+		for (const T& v : values) {
+			while (*link != nullptr && (*link)->value < v) {
+				link = &(*link)->next;
+			}
+			if (*link != nullptr && (*link)->value == v) {
+				node<T>* current = *link;
+				*link = current->next;
+				delete current;
+			}
+		}
+	}
+
 	/* count elements with value v in the list */
 	std::size_t count(T v) {
 
-		std::lock_guard<std::mutex> lock(mtx);
+		std::lock_guard<Lock> lock(mtx);
 
 		std::size_t cnt = 0;
 		/* first go to value v */
@@ -92,6 +92,7 @@ public:
 		}
 		if (current == nullptr || current->value != v) {
 			/* v not found */
+			set_unlock();
 			return;
 		}
 		/* remove current */
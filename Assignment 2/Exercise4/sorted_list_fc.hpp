@@ -0,0 +1,236 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "locks.hpp"
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+ /* struct for list nodes */
+template<typename T>
+struct node {
+	T value;
+	node<T>* next;
+};
+
+/* small dense numbers for the running threads: a thread gets the lowest
+ * free one on first use and gives it back when it exits, so a benchmark
+ * that starts new threads every round keeps using the same slots
+ */
+class thread_index {
+	int index;
+
+	static std::mutex& free_mutex() {
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	/* numbers given back by exited threads */
+	static std::vector<int>& free_list() {
+		static std::vector<int> list;
+		return list;
+	}
+
+	static int& next_index() {
+		static int next = 0;
+		return next;
+	}
+
+	thread_index() {
+		std::lock_guard<std::mutex> lock(free_mutex());
+		if (free_list().empty()) {
+			index = next_index()++;
+		} else {
+			auto lowest = std::min_element(free_list().begin(), free_list().end());
+			index = *lowest;
+			free_list().erase(lowest);
+		}
+	}
+
+	~thread_index() {
+		std::lock_guard<std::mutex> lock(free_mutex());
+		free_list().push_back(index);
+	}
+
+public:
+	static int get() {
+		static thread_local thread_index me;
+		return me.index;
+	}
+};
+
+/* sorted singly-linked list with flat combining (Hendler et al., 2010):
+ * a thread posts its operation in its own publication slot and then either
+ * waits for the answer or, if the combiner lock is free, becomes the
+ * combiner. The combiner collects all posted operations, sorts them by
+ * value and applies the whole batch in one pass over the list, so under
+ * contention the list is traversed once per batch instead of once per
+ * operation, and only one thread at a time touches its cache lines.
+ *
+ * Threads with an index of SLOTS or more have no slot; they take the
+ * combiner lock and run their operation on their own.
+ */
+template<typename T>
+class sorted_list {
+	static const int SLOTS = 128;
+	/* how often the combiner looks for more work before it lets go */
+	static const int COMBINE_PASSES = 4;
+
+	enum class operation { insert, remove, count };
+	enum slot_state { idle, pending, done };
+
+	struct alignas(CACHE_LINE_SIZE) slot {
+		std::atomic<int> state{idle};
+		/* written by the owner before pending, read by the combiner */
+		operation op;
+		T value;
+		/* written by the combiner before done */
+		std::size_t result;
+	};
+
+	/* an operation of the batch being combined */
+	struct request {
+		T value;
+		operation op;
+		/* the slot to answer, or nullptr */
+		slot* from;
+		std::size_t result;
+	};
+
+	node<T>* first = nullptr;
+	slot slots[SLOTS];
+	/* slots[0..used) may have requests */
+	std::atomic<int> used{0};
+	ttas_lock combiner;
+	std::vector<request> batch;
+
+	/* apply the sorted batch in one pass: link points at the pointer to the
+	 * first node that may hold the current request's value
+	 */
+	void apply_batch() {
+		node<T>** link = &first;
+		for (request& r : batch) {
+			while (*link != nullptr && (*link)->value < r.value) {
+				link = &(*link)->next;
+			}
+			std::size_t result = 0;
+			switch (r.op) {
+			case operation::insert: {
+				node<T>* current = new node<T>();
+				current->value = r.value;
+				current->next = *link;
+				*link = current;
+				break;
+			}
+			case operation::remove:
+				if (*link != nullptr && (*link)->value == r.value) {
+					node<T>* current = *link;
+					*link = current->next;
+					delete current;
+				}
+				break;
+			case operation::count:
+				for (node<T>* n = *link; n != nullptr && n->value == r.value; n = n->next) {
+					result++;
+				}
+				break;
+			}
+			r.result = result;
+			if (r.from != nullptr) {
+				r.from->result = result;
+				r.from->state.store(done, std::memory_order_release);
+			}
+		}
+	}
+
+	/* collect the posted requests, sorted by value; false if there are none */
+	bool collect() {
+		batch.clear();
+		int n = used.load(std::memory_order_acquire);
+		for (int i = 0; i < n; i++) {
+			slot& s = slots[i];
+			if (s.state.load(std::memory_order_acquire) == pending) {
+				batch.push_back(request{s.value, s.op, &s, 0});
+			}
+		}
+		std::sort(batch.begin(), batch.end(), [](const request& a, const request& b) { return a.value < b.value; });
+		return !batch.empty();
+	}
+
+	void combine() {
+		for (int pass = 0; pass < COMBINE_PASSES && collect(); pass++) {
+			apply_batch();
+		}
+	}
+
+	std::size_t execute(operation op, T v) {
+		int index = thread_index::get();
+		if (index >= SLOTS) {
+			/* no slot: run the operation alone as the combiner */
+			std::lock_guard<ttas_lock> lock(combiner);
+			batch.clear();
+			batch.push_back(request{v, op, nullptr, 0});
+			apply_batch();
+			std::size_t result = batch.front().result;
+			combine();
+			return result;
+		}
+		int n = used.load(std::memory_order_relaxed);
+		while (n <= index && !used.compare_exchange_weak(n, index + 1)) {
+			/* n is reloaded by the failed exchange */
+		}
+
+		slot& s = slots[index];
+		s.op = op;
+		s.value = v;
+		s.state.store(pending, std::memory_order_release);
+		while (s.state.load(std::memory_order_acquire) != done) {
+			if (combiner.try_lock()) {
+				combine();
+				combiner.unlock();
+			} else {
+				cpu_relax();
+			}
+		}
+		s.state.store(idle, std::memory_order_relaxed);
+		return s.result;
+	}
+
+public:
+	/* the publication slots belong to this list:
+	 * copying and moving are disabled
+	 */
+	sorted_list() = default;
+	sorted_list(const sorted_list& other) = delete;
+	sorted_list(sorted_list&& other) = delete;
+	sorted_list& operator=(const sorted_list& other) = delete;
+	sorted_list& operator=(sorted_list&& other) = delete;
+	~sorted_list() {
+		while (first != nullptr) {
+			node<T>* next = first->next;
+			delete first;
+			first = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+		execute(operation::insert, v);
+	}
+
+	void remove(T v) {
+		execute(operation::remove, v);
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+		return execute(operation::count, v);
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
@@ -2,153 +2,189 @@
 #define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
 
 #include <mutex>
+#include <vector>
+
+#include "locks.hpp"
+#include "sort_batch.hpp"
 
 /* a sorted list implementation by David Klaftenegger, 2015
  * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
  */
 
- /* struct for list nodes */
-template<typename T>
+ /* struct for list nodes, each with its own lock
+  * (ttas_lock is a single byte, a std::mutex is 40)
+  */
+template<typename T, typename Lock = ttas_lock>
 struct node {
 	T value;
-	node<T>* next;
-	std::mutex mtx; // fine-grained locking (again, using the std::mutex 
-
+	node<T, Lock>* next;
+	Lock mtx;
 };
 
-/* non-concurrent sorted singly-linked list */
-template<typename T>
+/* sorted singly-linked list with fine-grained locking by lock coupling
+ * (hand-over-hand): a thread holds the lock of the node it is at while it
+ * takes the lock of the next one, so it never walks over a node that is
+ * being changed, and threads further apart in the list work in parallel.
+ * Insert and remove change pred->next while holding both pred and the node
+ * after it, so nobody else can be between them.
+ *
+ * head and tail are sentinels: head is before and tail after every value,
+ * so every real node has a locked predecessor and successor. Only their
+ * addresses are compared, so T needs no minimum or maximum.
+ */
+template<typename T, typename Lock = ttas_lock>
 class sorted_list {
-	node<T>* first = nullptr;
+	typedef node<T, Lock> list_node;
+	list_node head;
+	list_node tail;
+
+	/* lock-couple from head to the first node with a value not below v;
+	 * returns with pred and curr (pred->next) locked
+	 */
+	void find(T v, list_node*& pred, list_node*& curr) {
+		pred = &head;
+		pred->mtx.lock();
+		curr = pred->next;
+		curr->mtx.lock();
+		advance(v, pred, curr);
+	}
 
+	/* the same, going on from pred and curr, which are locked */
+	void advance(T v, list_node*& pred, list_node*& curr) {
+		while (curr != &tail && curr->value < v) {
+			pred->mtx.unlock();
+			pred = curr;
+			curr = curr->next;
+			curr->mtx.lock();
+		}
+	}
 
 public:
-	/* default implementations:
-	 * default constructor
-	 * copy constructor (note: shallow copy)
-	 * move constructor
-	 * copy assignment operator (note: shallow copy)
-	 * move assignment operator
-	 *
-	 * The first is required due to the others,
-	 * which are explicitly listed due to the rule of five.
+	/* the sentinels are members, so a copy (even a shallow one)
+	 * would point into the other list: copying and moving are disabled
 	 */
-	sorted_list() = default;
-	sorted_list(const sorted_list<T>& other) = default;
-	sorted_list(sorted_list<T>&& other) = default;
-	sorted_list<T>& operator=(const sorted_list<T>& other) = default;
-	sorted_list<T>& operator=(sorted_list<T>&& other) = default;
+	sorted_list() {
+		head.next = &tail;
+		tail.next = nullptr;
+	}
+	sorted_list(const sorted_list& other) = delete;
+	sorted_list(sorted_list&& other) = delete;
+	sorted_list& operator=(const sorted_list& other) = delete;
+	sorted_list& operator=(sorted_list&& other) = delete;
 	~sorted_list() {
-		while (first != nullptr) {
-			remove(first->value);
+		list_node* current = head.next;
+		while (current != &tail) {
+			list_node* next = current->next;
+			delete current;
+			current = next;
 		}
 	}
 	/* insert v into the list */
 	void insert(T v) {
-		/* first find position */
-		node<T>* pred = nullptr;
-		node<T>* succ = first;
-
-		while (succ != nullptr && succ->value < v) {
-			succ->mtx.lock();
-			pred = succ;
-			succ->mtx.unlock();
-			succ = succ->next;
-			
-		}
-
-		/* construct new node */
-		node<T>* current = new node<T>();
-		current->value = v;
-
-
-
-		// locks
-		current->mtx.lock();
-
-		if (pred != nullptr)
-			pred->mtx.lock();
-
-		if (succ != nullptr)
-			succ->mtx.lock();
-
-
+		list_node* pred;
+		list_node* succ;
+		find(v, pred, succ);
 
 		/* insert new node between pred and succ */
-		// and unlock
+		list_node* current = new list_node();
+		current->value = v;
 		current->next = succ;
-		if (pred == nullptr) {
-			first = current;
-		}
-		else {
-			pred->next = current;
-			
-		}
-
-
-		if (succ != nullptr)
-			succ->mtx.unlock();
-
-		current->mtx.unlock();
-
-		if (pred != nullptr)
-			pred->mtx.unlock();
+		pred->next = current;
 
+		succ->mtx.unlock();
+		pred->mtx.unlock();
 	}
 
 	void remove(T v) {
-		/* first find position */
-		node<T>* pred = nullptr;
-		node<T>* current = first;
-		while (current != nullptr && current->value < v) {
-			pred = current;
-			current = current->next;
-		}
-		if (current == nullptr || current->value != v) {
+		list_node* pred;
+		list_node* current;
+		find(v, pred, current);
+		if (current == &tail || current->value != v) {
 			/* v not found */
+			current->mtx.unlock();
+			pred->mtx.unlock();
 			return;
 		}
+		/* remove current: anyone else on the way to it waits for pred */
+		pred->next = current->next;
+		current->mtx.unlock();
+		pred->mtx.unlock();
+		delete current;
+	}
 
-
-		// locks
-		current->mtx.lock();
-		if (pred != nullptr)
-			pred->mtx.lock();
-
-
-		/* remove current */
-		if (pred == nullptr) {
-			first = current->next;
+	/* insert all values, in one pass over the list: the values are sorted
+	 * first, so each one goes after the previous one and the traversal goes
+	 * on from there, holding only the two locks it is between
+	 */
+	void insert_batch(std::vector<T> values) {
+		if (values.empty()) {
+			return;
 		}
-		else {
-			pred->next = current->next;
+		sort_batch(values);
+		list_node* pred;
+		list_node* succ;
+		find(values.front(), pred, succ);
+		for (const T& v : values) {
+			advance(v, pred, succ);
+			/* insert new node between pred and succ, it becomes pred */
+			list_node* current = new list_node();
+			current->value = v;
+			current->next = succ;
+			current->mtx.lock();
+			pred->next = current;
+			pred->mtx.unlock();
+			pred = current;
 		}
+		succ->mtx.unlock();
+		pred->mtx.unlock();
+	}
 
-
-		if (pred != nullptr)
-			pred->mtx.lock();
-
+	/* remove one copy of each value (as often as it is in values),
+	 * in one pass over the list like insert_batch
+	 */
+	void remove_batch(std::vector<T> values) {
+		if (values.empty()) {
+			return;
+		}
+		sort_batch(values);
+		list_node* pred;
+		list_node* current;
+		find(values.front(), pred, current);
+		for (const T& v : values) {
+			advance(v, pred, current);
+			if (current == &tail || current->value != v) {
+				/* v not found */
+				continue;
+			}
+			/* remove current and go on with its successor */
+			list_node* next = current->next;
+			next->mtx.lock();
+			pred->next = next;
+			current->mtx.unlock();
+			delete current;
+			current = next;
+		}
 		current->mtx.unlock();
-		delete current;
-
+		pred->mtx.unlock();
 	}
 
 	/* count elements with value v in the list */
 	std::size_t count(T v) {
 		std::size_t cnt = 0;
 		/* first go to value v */
-		node<T>* current = first;
-		while (current != nullptr && current->value < v) {
-			current = current->next;
-		}
+		list_node* pred;
+		list_node* current;
+		find(v, pred, current);
 		/* count elements */
-		while (current != nullptr && current->value == v) {
-			current->mtx.lock();
+		while (current != &tail && current->value == v) {
 			cnt++;
-			if (current != nullptr)
-				current->mtx.unlock();
+			pred->mtx.unlock();
+			pred = current;
 			current = current->next;
+			current->mtx.lock();
 		}
+		current->mtx.unlock();
+		pred->mtx.unlock();
 		return cnt;
 	}
 };
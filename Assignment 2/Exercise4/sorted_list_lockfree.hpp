@@ -0,0 +1,175 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <atomic>
+#include <cstdint>
+
+#include "epoch_reclamation.hpp"
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+ /* struct for list nodes: the lowest bit of next marks the node as removed */
+template<typename T>
+struct node {
+	T value;
+	std::atomic<node<T>*> next{nullptr};
+};
+
+/* lock-free sorted singly-linked list (Harris, 2001) with duplicates:
+ * insert always adds a node (before the copies of v already there), remove
+ * takes away one copy and count returns the number of copies.
+ *
+ * A node is removed in two steps: first it is marked by setting the lowest
+ * bit of its next pointer, which makes it logically deleted and keeps
+ * anyone from linking a node after it, then it is unlinked from its
+ * predecessor. Searches unlink the marked nodes they come across, so a
+ * remove that fails to unlink its node leaves that to the next search.
+ * Unlinked nodes are freed by epoch_reclamation once no thread can see them.
+ *
+ * count() only reads: it counts the unmarked copies of v it passes, so with
+ * concurrent updates it sees each copy either before or after its update.
+ */
+template<typename T>
+class sorted_list {
+	typedef node<T> list_node;
+	list_node head;
+	list_node tail;
+
+	static bool is_marked(list_node* p) {
+		return reinterpret_cast<std::uintptr_t>(p) & 1;
+	}
+
+	static list_node* marked(list_node* p) {
+		return reinterpret_cast<list_node*>(reinterpret_cast<std::uintptr_t>(p) | 1);
+	}
+
+	static list_node* unmarked(list_node* p) {
+		return reinterpret_cast<list_node*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));
+	}
+
+	/* the first unmarked node with a value >= v (right, possibly tail) and
+	 * the unmarked node before it (left), with left->next == right; marked
+	 * nodes found between them are unlinked and retired
+	 */
+	list_node* search(T v, list_node*& left) {
+		while (true) {
+			list_node* left_next = nullptr;
+			list_node* t = &head;
+			list_node* t_next = head.next.load(std::memory_order_acquire);
+			/* find left and right */
+			do {
+				if (!is_marked(t_next)) {
+					left = t;
+					left_next = t_next;
+				}
+				t = unmarked(t_next);
+				if (t == &tail) {
+					break;
+				}
+				t_next = t->next.load(std::memory_order_acquire);
+			} while (is_marked(t_next) || t->value < v);
+			list_node* right = t;
+
+			if (left_next != right) {
+				/* unlink the marked nodes between left and right */
+				if (!left->next.compare_exchange_strong(left_next, right, std::memory_order_acq_rel)) {
+					continue;
+				}
+				while (left_next != right) {
+					list_node* next = unmarked(left_next->next.load(std::memory_order_relaxed));
+					epoch_reclamation::retire(left_next);
+					left_next = next;
+				}
+			}
+			if (right == &tail || !is_marked(right->next.load(std::memory_order_acquire))) {
+				return right;
+			}
+		}
+	}
+
+public:
+	/* the sentinels are members, so a copy (even a shallow one)
+	 * would point into the other list: copying and moving are disabled
+	 */
+	sorted_list() {
+		head.next.store(&tail, std::memory_order_relaxed);
+	}
+	sorted_list(const sorted_list& other) = delete;
+	sorted_list(sorted_list&& other) = delete;
+	sorted_list& operator=(const sorted_list& other) = delete;
+	sorted_list& operator=(sorted_list&& other) = delete;
+	~sorted_list() {
+		list_node* current = unmarked(head.next.load(std::memory_order_relaxed));
+		while (current != &tail) {
+			list_node* next = unmarked(current->next.load(std::memory_order_relaxed));
+			delete current;
+			current = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+		epoch_guard guard;
+		/* construct new node */
+		list_node* current = new list_node();
+		current->value = v;
+		while (true) {
+			/* find position and insert new node between pred and succ */
+			list_node* pred;
+			list_node* succ = search(v, pred);
+			current->next.store(succ, std::memory_order_relaxed);
+			if (pred->next.compare_exchange_strong(succ, current, std::memory_order_release)) {
+				return;
+			}
+		}
+	}
+
+	void remove(T v) {
+		epoch_guard guard;
+		while (true) {
+			/* first find position */
+			list_node* pred;
+			list_node* current = search(v, pred);
+			if (current == &tail || current->value != v) {
+				/* v not found */
+				return;
+			}
+			/* mark current as removed; if someone else was faster, try the next copy */
+			list_node* succ = current->next.load(std::memory_order_acquire);
+			if (is_marked(succ) || !current->next.compare_exchange_strong(succ, marked(succ), std::memory_order_acq_rel)) {
+				continue;
+			}
+			/* unlink it, or let a search do that */
+			list_node* expected = current;
+			if (pred->next.compare_exchange_strong(expected, succ, std::memory_order_acq_rel)) {
+				epoch_reclamation::retire(current);
+			} else {
+				search(v, pred);
+			}
+			return;
+		}
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+		epoch_guard guard;
+		std::size_t cnt = 0;
+		/* first go to value v */
+		list_node* current = unmarked(head.next.load(std::memory_order_acquire));
+		while (current != &tail && current->value < v) {
+			current = unmarked(current->next.load(std::memory_order_acquire));
+		}
+		/* count elements that are not removed */
+		while (current != &tail && current->value == v) {
+			list_node* next = current->next.load(std::memory_order_acquire);
+			if (!is_marked(next)) {
+				cnt++;
+			}
+			current = unmarked(next);
+		}
+		return cnt;
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
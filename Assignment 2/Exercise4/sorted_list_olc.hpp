@@ -0,0 +1,208 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <atomic>
+#include <cstdint>
+
+#include "locks.hpp"
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+ /* struct for list nodes: the fields are atomic because readers look at
+  * them without a lock while a writer may change them
+  */
+template<typename T>
+struct node {
+	std::atomic<T> value;
+	std::atomic<node<T>*> next{nullptr};
+	/* odd while a writer holds the node, +1 on every lock and unlock */
+	std::atomic<std::uint64_t> version{0};
+};
+
+/* sorted singly-linked list with optimistic lock coupling (Leis et al., 2016):
+ * every node has a version counter that doubles as its lock. Readers never
+ * write: they remember the version of a node, read its fields and check the
+ * version again before trusting what they read, so count() touches no shared
+ * cache line in exclusive mode. On a conflict the operation starts over.
+ * A reader moving from one node to the next checks the first one again after
+ * reading the version of the second, so the second was its successor then.
+ *
+ * Writers search the same way and then lock only what they change (by
+ * moving the version from the one they read to odd): insert locks pred,
+ * remove locks pred and the removed node.
+ *
+ * Readers may still look at a removed node, so nodes are never freed while
+ * the list is in use; removed nodes go to a node_pool and are reused, and
+ * the versions tell readers that a node has changed. T has to be trivially
+ * copyable (it is kept in a std::atomic).
+ */
+template<typename T>
+class sorted_list {
+	typedef node<T> list_node;
+	list_node head;
+	list_node tail;
+
+	/* wait until no writer holds n and return its version */
+	static std::uint64_t stable_version(list_node* n) {
+		std::uint64_t version = n->version.load(std::memory_order_acquire);
+		while (version & 1) {
+			cpu_relax();
+			version = n->version.load(std::memory_order_acquire);
+		}
+		return version;
+	}
+
+	static bool validate(list_node* n, std::uint64_t version) {
+		return n->version.load(std::memory_order_acquire) == version;
+	}
+
+	/* lock n, if it is still as it was at version */
+	static bool upgrade(list_node* n, std::uint64_t version) {
+		return n->version.compare_exchange_strong(version, version + 1, std::memory_order_acquire);
+	}
+
+	static void unlock(list_node* n) {
+		n->version.fetch_add(1, std::memory_order_release);
+	}
+
+	/* move from curr to its successor; false if curr changed meanwhile */
+	bool advance(list_node*& curr, std::uint64_t& version) {
+		list_node* next = curr->next.load(std::memory_order_acquire);
+		if (!validate(curr, version)) {
+			return false;
+		}
+		std::uint64_t next_version = stable_version(next);
+		if (!validate(curr, version)) {
+			return false;
+		}
+		curr = next;
+		version = next_version;
+		return true;
+	}
+
+	/* optimistic search for the first node with a value not below v:
+	 * on success curr (tail if there is none) and its predecessor pred were
+	 * as read at cv and pv, and curr's value has been checked against cv
+	 */
+	bool find(T v, list_node*& pred, std::uint64_t& pv, list_node*& curr, std::uint64_t& cv) {
+		curr = &head;
+		cv = stable_version(curr);
+		while (true) {
+			pred = curr;
+			pv = cv;
+			if (!advance(curr, cv)) {
+				return false;
+			}
+			if (curr == &tail || !(curr->value.load(std::memory_order_acquire) < v)) {
+				return validate(curr, cv);
+			}
+		}
+	}
+
+public:
+	/* the sentinels are members, so a copy (even a shallow one)
+	 * would point into the other list: copying and moving are disabled
+	 */
+	sorted_list() {
+		head.next.store(&tail, std::memory_order_relaxed);
+	}
+	sorted_list(const sorted_list& other) = delete;
+	sorted_list(sorted_list&& other) = delete;
+	sorted_list& operator=(const sorted_list& other) = delete;
+	sorted_list& operator=(sorted_list&& other) = delete;
+	~sorted_list() {
+		list_node* current = head.next.load(std::memory_order_relaxed);
+		while (current != &tail) {
+			list_node* next = current->next.load(std::memory_order_relaxed);
+			delete current;
+			current = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+		while (true) {
+			/* first find position */
+			list_node* pred;
+			list_node* succ;
+			std::uint64_t pv, sv;
+			if (!find(v, pred, pv, succ, sv)) {
+				continue;
+			}
+			/* lock pred as it was found, so succ is still after it */
+			if (!upgrade(pred, pv)) {
+				continue;
+			}
+			/* construct new node (maybe a reused one) and insert it between pred and succ */
+			list_node* current = node_pool<list_node>::local().get();
+			current->value.store(v, std::memory_order_release);
+			current->next.store(succ, std::memory_order_release);
+			pred->next.store(current, std::memory_order_release);
+			unlock(pred);
+			return;
+		}
+	}
+
+	void remove(T v) {
+		while (true) {
+			/* first find position */
+			list_node* pred;
+			list_node* current;
+			std::uint64_t pv, cv;
+			if (!find(v, pred, pv, current, cv)) {
+				continue;
+			}
+			bool found = current != &tail && current->value.load(std::memory_order_acquire) == v;
+			if (!validate(current, cv)) {
+				continue;
+			}
+			if (!found) {
+				/* v not found */
+				return;
+			}
+			/* lock pred and current as they were found */
+			if (!upgrade(pred, pv)) {
+				continue;
+			}
+			if (!upgrade(current, cv)) {
+				unlock(pred);
+				continue;
+			}
+			/* remove current; readers still on it see its version change */
+			pred->next.store(current->next.load(std::memory_order_relaxed), std::memory_order_release);
+			unlock(current);
+			unlock(pred);
+			node_pool<list_node>::local().put(current);
+			return;
+		}
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+		while (true) {
+			/* first go to value v */
+			list_node* pred;
+			list_node* current;
+			std::uint64_t pv, cv;
+			if (!find(v, pred, pv, current, cv)) {
+				continue;
+			}
+			/* count elements */
+			std::size_t cnt = 0;
+			bool valid = true;
+			while (current != &tail && current->value.load(std::memory_order_acquire) == v) {
+				cnt++;
+				if (!advance(current, cv)) {
+					valid = false;
+					break;
+				}
+			}
+			if (valid && validate(current, cv)) {
+				return cnt;
+			}
+		}
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
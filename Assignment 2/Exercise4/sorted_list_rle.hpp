@@ -0,0 +1,163 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+ /* struct for list nodes: one node per distinct value, with the number of copies */
+template<typename T>
+struct node {
+	T value;
+	std::atomic<std::size_t> multiplicity{1};
+	node<T>* next;
+};
+
+/* sorted singly-linked list of (value, multiplicity) pairs: inserting a value
+ * that is already there increments its node, and count() stops at the
+ * first node with value >= v instead of walking every copy.
+ *
+ * Behind one coarse-grained reader-writer lock (any of rw_locks.hpp or
+ * std::shared_mutex), but only changes to the list structure need it
+ * exclusively: count(), an insert of a present value and a remove that
+ * leaves at least one copy hold it shared and only update the node's
+ * atomic multiplicity. Adding a new value or removing the last copy of one
+ * takes the lock exclusively and searches again.
+ */
+template<typename T, typename RwLock = std::shared_mutex>
+class sorted_list {
+	node<T>* first = nullptr;
+	RwLock mtx;
+
+	/* first node with value >= v and its predecessor (nullptr if there is none) */
+	void find(T v, node<T>*& pred, node<T>*& current) {
+		pred = nullptr;
+		current = first;
+		while (current != nullptr && current->value < v) {
+			pred = current;
+			current = current->next;
+		}
+	}
+
+	static bool holds(node<T>* current, T v) {
+		return current != nullptr && current->value == v;
+	}
+
+public:
+	/* default implementations:
+	 * default constructor
+	 * copy constructor (note: shallow copy)
+	 * move constructor
+	 * copy assignment operator (note: shallow copy)
+	 * move assignment operator
+	 *
+	 * The first is required due to the others,
+	 * which are explicitly listed due to the rule of five.
+	 */
+	sorted_list() = default;
+	sorted_list(const sorted_list& other) = default;
+	sorted_list(sorted_list&& other) = default;
+	sorted_list& operator=(const sorted_list& other) = default;
+	sorted_list& operator=(sorted_list&& other) = default;
+	~sorted_list() {
+		while (first != nullptr) {
+			node<T>* next = first->next;
+			delete first;
+			first = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+		node<T>* pred;
+		node<T>* current;
+		{
+			std::shared_lock<RwLock> lock(mtx);
+			find(v, pred, current);
+			if (holds(current, v)) {
+				/* another copy of v */
+				current->multiplicity.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		std::unique_lock<RwLock> lock(mtx);
+
+		/* search again: v may have been added in between */
+		find(v, pred, current);
+		if (holds(current, v)) {
+			current->multiplicity.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		/* construct new node */
+		node<T>* succ = current;
+		current = new node<T>();
+		current->value = v;
+
+		/* insert new node between pred and succ */
+		current->next = succ;
+		if (pred == nullptr) {
+			first = current;
+		}
+		else {
+			pred->next = current;
+		}
+	}
+
+	void remove(T v) {
+		node<T>* pred;
+		node<T>* current;
+		{
+			std::shared_lock<RwLock> lock(mtx);
+			find(v, pred, current);
+			if (!holds(current, v)) {
+				/* v not found */
+				return;
+			}
+			/* take away a copy, unless it is the last one */
+			std::size_t m = current->multiplicity.load(std::memory_order_relaxed);
+			while (m > 1) {
+				if (current->multiplicity.compare_exchange_weak(m, m - 1, std::memory_order_relaxed)) {
+					return;
+				}
+			}
+		}
+
+		std::unique_lock<RwLock> lock(mtx);
+
+		find(v, pred, current);
+		if (!holds(current, v)) {
+			/* removed in between */
+			return;
+		}
+		if (current->multiplicity.fetch_sub(1, std::memory_order_relaxed) > 1) {
+			/* inserted again in between */
+			return;
+		}
+		/* remove current */
+		if (pred == nullptr) {
+			first = current->next;
+		}
+		else {
+			pred->next = current->next;
+		}
+		delete current;
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+
+		std::shared_lock<RwLock> lock(mtx);
+
+		node<T>* pred;
+		node<T>* current;
+		find(v, pred, current);
+		return holds(current, v) ? current->multiplicity.load(std::memory_order_relaxed) : 0;
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
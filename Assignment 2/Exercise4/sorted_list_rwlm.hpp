@@ -0,0 +1,120 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <mutex>
+#include <shared_mutex>
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+ /* struct for list nodes */
+template<typename T>
+struct node {
+	T value;
+	node<T>* next;
+};
+
+/* sorted singly-linked list behind one coarse-grained reader-writer lock:
+ * count() only reads, so any number of counts can run at the same time.
+ * RwLock can be std::shared_mutex or any of the locks in rw_locks.hpp
+ */
+template<typename T, typename RwLock = std::shared_mutex>
+class sorted_list {
+	node<T>* first = nullptr;
+	RwLock mtx;
+
+public:
+	/* default implementations:
+	 * default constructor
+	 * copy constructor (note: shallow copy)
+	 * move constructor
+	 * copy assignment operator (note: shallow copy)
+	 * move assignment operator
+	 *
+	 * The first is required due to the others,
+	 * which are explicitly listed due to the rule of five.
+	 */
+	sorted_list() = default;
+	sorted_list(const sorted_list& other) = default;
+	sorted_list(sorted_list&& other) = default;
+	sorted_list& operator=(const sorted_list& other) = default;
+	sorted_list& operator=(sorted_list&& other) = default;
+	~sorted_list() {
+		while (first != nullptr) {
+			remove(first->value);
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+
+		std::unique_lock<RwLock> lock(mtx);
+
+		/* first find position */
+		node<T>* pred = nullptr;
+		node<T>* succ = first;
+		while (succ != nullptr && succ->value < v) {
+			pred = succ;
+			succ = succ->next;
+		}
+
+		/* construct new node */
+		node<T>* current = new node<T>();
+		current->value = v;
+
+		/* insert new node between pred and succ */
+		current->next = succ;
+		if (pred == nullptr) {
+			first = current;
+		}
+		else {
+			pred->next = current;
+		}
+	}
+
+	void remove(T v) {
+
+		std::unique_lock<RwLock> lock(mtx);
+
+		/* first find position */
+		node<T>* pred = nullptr;
+		node<T>* current = first;
+		while (current != nullptr && current->value < v) {
+			pred = current;
+			current = current->next;
+		}
+		if (current == nullptr || current->value != v) {
+			/* v not found */
+			return;
+		}
+		/* remove current */
+		if (pred == nullptr) {
+			first = current->next;
+		}
+		else {
+			pred->next = current->next;
+		}
+		delete current;
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+
+		std::shared_lock<RwLock> lock(mtx);
+
+		std::size_t cnt = 0;
+		/* first go to value v */
+		node<T>* current = first;
+		while (current != nullptr && current->value < v) {
+			current = current->next;
+		}
+		/* count elements */
+		while (current != nullptr && current->value == v) {
+			cnt++;
+			current = current->next;
+		}
+		return cnt;
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
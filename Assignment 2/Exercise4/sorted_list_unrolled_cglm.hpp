@@ -0,0 +1,117 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include <mutex>
+
+#include "unrolled_node.hpp"
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+/* unrolled sorted list (see unrolled_node.hpp) behind one coarse-grained lock;
+ * Lock can be std::mutex or any of the locks in locks.hpp
+ */
+template<typename T, typename Lock = std::mutex>
+class sorted_list {
+	typedef unrolled_node<T> list_node;
+	list_node* first = nullptr;
+	Lock mtx;
+
+public:
+	/* default implementations:
+	 * default constructor
+	 * copy constructor (note: shallow copy)
+	 * move constructor
+	 * copy assignment operator (note: shallow copy)
+	 * move assignment operator
+	 *
+	 * The first is required due to the others,
+	 * which are explicitly listed due to the rule of five.
+	 */
+	sorted_list() = default;
+	sorted_list(const sorted_list& other) = default;
+	sorted_list(sorted_list&& other) = default;
+	sorted_list& operator=(const sorted_list& other) = default;
+	sorted_list& operator=(sorted_list&& other) = default;
+	~sorted_list() {
+		while (first != nullptr) {
+			list_node* next = first->next;
+			delete first;
+			first = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+
+		std::lock_guard<Lock> lock(mtx);
+
+		if (first == nullptr) {
+			first = new list_node();
+		}
+		/* first find the node: the first one that has values >= v, or the last one */
+		list_node* current = first;
+		while (current->next != nullptr && current->back() < v) {
+			current = current->next;
+		}
+		if (current->full()) {
+			/* v belongs in the upper half if it is not below its smallest value */
+			list_node* upper = current->split();
+			if (!(v < upper->front())) {
+				current = upper;
+			}
+		}
+		current->insert(v);
+	}
+
+	void remove(T v) {
+
+		std::lock_guard<Lock> lock(mtx);
+
+		/* first find the node: if v is in the list, it is in the first one with values >= v */
+		list_node* pred = nullptr;
+		list_node* current = first;
+		while (current != nullptr && current->back() < v) {
+			pred = current;
+			current = current->next;
+		}
+		if (current == nullptr || !current->remove(v)) {
+			/* v not found */
+			return;
+		}
+		if (current->size == 0) {
+			/* unlink the empty node */
+			if (pred == nullptr) {
+				first = current->next;
+			}
+			else {
+				pred->next = current->next;
+			}
+			delete current;
+		}
+		else if (current->should_merge()) {
+			delete current->merge_next();
+		}
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+
+		std::lock_guard<Lock> lock(mtx);
+
+		std::size_t cnt = 0;
+		/* first go to the node with value v */
+		list_node* current = first;
+		while (current != nullptr && current->back() < v) {
+			current = current->next;
+		}
+		/* count elements, which may go on in the following nodes */
+		while (current != nullptr && !(v < current->front())) {
+			cnt += current->count(v);
+			current = current->next;
+		}
+		return cnt;
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
@@ -0,0 +1,155 @@
+#ifndef lacpp_sorted_list_hpp
+#define lacpp_sorted_list_hpp lacpp_sorted_list_hpp
+
+#include "unrolled_node.hpp"
+
+/* a sorted list implementation by David Klaftenegger, 2015
+ * please report bugs or suggest improvements to david.klaftenegger@it.uu.se
+ */
+
+/* unrolled sorted list (see unrolled_node.hpp) with fine-grained locking by
+ * lock coupling, as in sorted_list_fglm.hpp: a thread takes the lock of the
+ * next node before it lets go of the current one. A split only changes the
+ * node being split (the new node can only be reached through it), removing
+ * an empty node changes its predecessor, and a merge takes the lock of the
+ * successor next, so locks are always taken front to back.
+ *
+ * head is an empty sentinel node before all others, so every node has a
+ * predecessor to lock.
+ */
+template<typename T>
+class sorted_list {
+	typedef unrolled_node<T> list_node;
+	list_node head;
+
+	/* lock-couple from head to the first node with values >= v; with
+	 * keep_last it stops at the last node instead of running past it.
+	 * Returns with pred and curr locked (curr unless it is nullptr)
+	 */
+	void find(T v, bool keep_last, list_node*& pred, list_node*& curr) {
+		pred = &head;
+		pred->mtx.lock();
+		curr = pred->next;
+		if (curr == nullptr) {
+			return;
+		}
+		curr->mtx.lock();
+		while (curr->back() < v && (curr->next != nullptr || !keep_last)) {
+			pred->mtx.unlock();
+			pred = curr;
+			curr = curr->next;
+			if (curr == nullptr) {
+				return;
+			}
+			curr->mtx.lock();
+		}
+	}
+
+	static void unlock(list_node* pred, list_node* curr) {
+		if (curr != nullptr) {
+			curr->mtx.unlock();
+		}
+		pred->mtx.unlock();
+	}
+
+public:
+	/* the head sentinel is a member, so a copy (even a shallow one)
+	 * would share the other list's nodes: copying and moving are disabled
+	 */
+	sorted_list() = default;
+	sorted_list(const sorted_list& other) = delete;
+	sorted_list(sorted_list&& other) = delete;
+	sorted_list& operator=(const sorted_list& other) = delete;
+	sorted_list& operator=(sorted_list&& other) = delete;
+	~sorted_list() {
+		list_node* current = head.next;
+		while (current != nullptr) {
+			list_node* next = current->next;
+			delete current;
+			current = next;
+		}
+	}
+	/* insert v into the list */
+	void insert(T v) {
+		/* first find the node: the first one that has values >= v, or the last one */
+		list_node* pred;
+		list_node* current;
+		find(v, true, pred, current);
+		if (current == nullptr) {
+			/* empty list */
+			current = new list_node();
+			current->insert(v);
+			pred->next = current;
+			pred->mtx.unlock();
+			return;
+		}
+		/* only current changes, so pred can go */
+		pred->mtx.unlock();
+		if (current->full()) {
+			/* v belongs in the upper half if it is not below its smallest value */
+			list_node* upper = current->split();
+			if (!(v < upper->front())) {
+				upper->insert(v);
+				current->mtx.unlock();
+				return;
+			}
+		}
+		current->insert(v);
+		current->mtx.unlock();
+	}
+
+	void remove(T v) {
+		/* first find the node: if v is in the list, it is in the first one with values >= v */
+		list_node* pred;
+		list_node* current;
+		find(v, false, pred, current);
+		if (current == nullptr || !current->remove(v)) {
+			/* v not found */
+			unlock(pred, current);
+			return;
+		}
+		if (current->size == 0) {
+			/* unlink the empty node: anyone else on the way to it waits for pred */
+			pred->next = current->next;
+			unlock(pred, current);
+			delete current;
+			return;
+		}
+		pred->mtx.unlock();
+		list_node* merged = nullptr;
+		/* next->size may only be read with next locked */
+		if (current->next != nullptr && current->size < list_node::MERGE_BELOW) {
+			list_node* next = current->next;
+			next->mtx.lock();
+			if (current->should_merge()) {
+				merged = current->merge_next();
+			}
+			next->mtx.unlock();
+		}
+		current->mtx.unlock();
+		delete merged;
+	}
+
+	/* count elements with value v in the list */
+	std::size_t count(T v) {
+		std::size_t cnt = 0;
+		/* first go to the node with value v */
+		list_node* pred;
+		list_node* current;
+		find(v, false, pred, current);
+		/* count elements, which may go on in the following nodes */
+		while (current != nullptr && !(v < current->front())) {
+			cnt += current->count(v);
+			pred->mtx.unlock();
+			pred = current;
+			current = current->next;
+			if (current != nullptr) {
+				current->mtx.lock();
+			}
+		}
+		unlock(pred, current);
+		return cnt;
+	}
+};
+
+#endif // lacpp_sorted_list_hpp
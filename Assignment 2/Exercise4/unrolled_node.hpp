@@ -0,0 +1,118 @@
+#ifndef lacpp_unrolled_node_hpp
+#define lacpp_unrolled_node_hpp lacpp_unrolled_node_hpp
+
+/* node of an unrolled sorted list: instead of one value per node, each
+ * node fills two cache lines with a small sorted array of values, so a
+ * traversal takes one cache miss per CAPACITY values instead of one per
+ * value. All values of a node are <= all values of the next node.
+ *
+ * The searches within a node count matching elements over the whole array
+ * instead of stopping at the first one; without branches the compiler
+ * turns these loops into SIMD comparisons.
+ */
+
+#include <algorithm>
+#include <cstddef>
+
+#include "locks.hpp"
+
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) unrolled_node {
+	static const int HEADER = sizeof(void*) + 2 * sizeof(int);
+	static const int CAPACITY = std::max<int>(4, (2 * CACHE_LINE_SIZE - HEADER) / sizeof(T));
+	/* a node that shrinks below MERGE_BELOW takes over its successor if
+	 * both fit in MERGE_LIMIT, leaving room for inserts before the next split
+	 */
+	static const int MERGE_BELOW = CAPACITY / 4;
+	static const int MERGE_LIMIT = CAPACITY * 3 / 4;
+
+	unrolled_node<T>* next = nullptr;
+	int size = 0;
+	ttas_lock mtx; // only used by the fine-grained list
+	T values[CAPACITY];
+
+	bool full() const {
+		return size == CAPACITY;
+	}
+
+	/* only for non-empty nodes */
+	T front() const {
+		return values[0];
+	}
+
+	T back() const {
+		return values[size - 1];
+	}
+
+	/* number of values < v, i.e. the position of the first value >= v */
+	int lower_bound(T v) const {
+		int pos = 0;
+		for (int i = 0; i < size; i++) {
+			pos += values[i] < v;
+		}
+		return pos;
+	}
+
+	/* number of values <= v, i.e. the position after the last value <= v */
+	int upper_bound(T v) const {
+		int pos = 0;
+		for (int i = 0; i < size; i++) {
+			pos += !(v < values[i]);
+		}
+		return pos;
+	}
+
+	std::size_t count(T v) const {
+		std::size_t cnt = 0;
+		for (int i = 0; i < size; i++) {
+			cnt += values[i] == v;
+		}
+		return cnt;
+	}
+
+	/* insert v into a node that is not full */
+	void insert(T v) {
+		int pos = upper_bound(v);
+		std::copy_backward(values + pos, values + size, values + size + 1);
+		values[pos] = v;
+		size++;
+	}
+
+	/* remove one v, if there is one */
+	bool remove(T v) {
+		int pos = lower_bound(v);
+		if (pos == size || !(values[pos] == v)) {
+			return false;
+		}
+		std::copy(values + pos + 1, values + size, values + pos);
+		size--;
+		return true;
+	}
+
+	/* move the upper half of the values into a new node after this one */
+	unrolled_node<T>* split() {
+		unrolled_node<T>* upper = new unrolled_node<T>();
+		int half = size / 2;
+		std::copy(values + half, values + size, upper->values);
+		upper->size = size - half;
+		size = half;
+		upper->next = next;
+		next = upper;
+		return upper;
+	}
+
+	bool should_merge() const {
+		return next != nullptr && size < MERGE_BELOW && size + next->size <= MERGE_LIMIT;
+	}
+
+	/* take over all values of the next node and unlink it; returns it for deletion */
+	unrolled_node<T>* merge_next() {
+		unrolled_node<T>* other = next;
+		std::copy(other->values, other->values + other->size, values + size);
+		size += other->size;
+		next = other->next;
+		return other;
+	}
+};
+
+#endif // lacpp_unrolled_node_hpp
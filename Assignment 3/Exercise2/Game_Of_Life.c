@@ -4,6 +4,8 @@
 
  Usage: ./exec ArraySize TimeSteps                   
 
+ Compile with -O3 -fopenmp; at -O3 the inner loop
+ over a row is vectorized.
  Compile with -DOUTPUT to print output in output.gif 
  (You will need FFmpeg for that; install it with
   sudo apt-get install ffmpeg)
@@ -14,6 +16,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <sys/time.h>
 #include <omp.h>
 
@@ -22,38 +26,65 @@ ffmpeg -y -start_number 0 -i out%d.pgm output.gif\n\
 rm *pgm\n\
 "
 
-static int ** allocate_array(int N) {
-	int ** array;
-	int i, j;
-	array = malloc(N * sizeof(int*));
-	for (i = 0; i < N ; i++)
-		array[i] = malloc(N * sizeof(int));
+#define SEED 0x5eed
+
+/* An N x N grid of one byte cells in a single allocation. The first and
+ * last row and column are the halo: they stay dead, so every computed cell
+ * has all eight neighbours. Rows start on a cache line, and the pitch is an
+ * odd number of cache lines so that the three rows read for one output row
+ * do not map to the same cache sets.
+ */
+typedef struct {
+	int N;
+	int pitch;		// bytes per row
+	unsigned char * cells;
+} grid;
+
+static unsigned char * row(grid * array, int i) {
+	return array->cells + (size_t)i * array->pitch;
+}
+
+/* the pages of a row are first touched by the thread that computes it */
+static grid allocate_array(int N, int num_threads) {
+	grid array;
+	int i;
+	array.N = N;
+	array.pitch = (N + 63) / 64 * 64;
+	if ((array.pitch / 64) % 2 == 0)
+		array.pitch += 64;
+	array.cells = aligned_alloc(64, (size_t)N * array.pitch);
+#pragma omp parallel for num_threads(num_threads) schedule(static)
 	for (i = 0; i < N ; i++)
-		for (j = 0; j < N ; j++)
-			array[i][j] = 0;
+		memset(row(&array, i), 0, array.pitch);
 	return array;
 }
 
-static void free_array(int ** array, int N) {
-	int i;
-	for (i = 0 ; i < N ; i++)
-		free(array[i]);
-	free(array);
+static void free_array(grid * array) {
+	free(array->cells);
 }
 
-static void init_random(int ** array1, int ** array2, int N) {
-	int i, pos;
-	
-	for (i = 0 ; i < (N * N)/10 ; i++) {
-		pos = rand() % ((N-2)*(N-2));
-		array1[pos%(N-2)+1][pos/(N-2)+1] = 1;
-		array2[pos%(N-2)+1][pos/(N-2)+1] = 1;
+/* counter-based random bits: the value for a cell depends only on its
+ * position, so the rows can be filled in parallel (splitmix64 finalizer)
+ */
+static uint64_t random_bits(uint64_t counter) {
+	uint64_t z = SEED + counter * 0x9e3779b97f4a7c15ull;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
 
-	}
+/* every inner cell is alive with probability 1/10 */
+static void init_random(grid * array, int num_threads) {
+	int i, j, N = array->N;
+
+#pragma omp parallel for num_threads(num_threads) private(j) schedule(static)
+	for (i = 1 ; i < N-1 ; i++)
+		for (j = 1 ; j < N-1 ; j++)
+			row(array, i)[j] = random_bits((uint64_t)i * N + j) < UINT64_MAX / 10;
 }
 
 #ifdef OUTPUT
-static void print_to_pgm(int ** array, int N, int t) {
+static void print_to_pgm(grid * array, int N, int t) {
 	int i, j;
 	char * s = malloc(30*sizeof(char));
 	sprintf(s, "out%d.pgm", t);
@@ -61,7 +92,7 @@ static void print_to_pgm(int ** array, int N, int t) {
 	fprintf(f, "P5\n%d %d 1\n", N,N);
 	for (i = 0; i < N ; i++) 
 		for (j = 0; j < N ; j++)
-			if (array[i][j] == 1)
+			if (row(array, i)[j] == 1)
 				fputc(1, f);
 			else
 				fputc(0, f);
@@ -73,8 +104,9 @@ static void print_to_pgm(int ** array, int N, int t) {
 int main (int argc, char * argv[]) {
 	int N;	 			//array dimensions
 	int T; 				//time steps
-	int ** current, ** previous; 	//arrays - one for current timestep, one for previous timestep
-	int ** swap;			//array pointer
+	grid a, b;			//arrays - one for current timestep, one for previous timestep
+	grid * current, * previous;
+	grid * swap;			//array pointer
 	int t, i, j, nbrs;		//helper variables
 	int num_threads;		// num of threads to run with
 
@@ -93,10 +125,12 @@ int main (int argc, char * argv[]) {
 	}
 
 	/*Allocate and initialize matrices*/
-	current = allocate_array(N);			//allocate array for current time step
-	previous = allocate_array(N); 			//allocate array for previous time step
+	a = allocate_array(N, num_threads);		//allocate array for current time step
+	b = allocate_array(N, num_threads);		//allocate array for previous time step
+	current = &a;
+	previous = &b;
 
-	init_random(previous, current, N);	//initialize previous array with pattern
+	init_random(previous, num_threads);	//initialize previous array with pattern
 
 	#ifdef OUTPUT
 	print_to_pgm(previous, N, 0);
@@ -107,16 +141,18 @@ int main (int argc, char * argv[]) {
 	gettimeofday(&ts,NULL);
 	for (t = 0 ; t < T ; t++) {
 #pragma omp parallel for num_threads(num_threads) private(i, j, nbrs) schedule(static)
-		for (i = 1 ; i < N-1 ; i++)
+		for (i = 1 ; i < N-1 ; i++) {
+			const unsigned char * restrict up = row(previous, i-1);
+			const unsigned char * restrict mid = row(previous, i);
+			const unsigned char * restrict down = row(previous, i+1);
+			unsigned char * restrict out = row(current, i);
 			for (j = 1 ; j < N-1 ; j++) {
-				nbrs = previous[i+1][j+1] + previous[i+1][j] + previous[i+1][j-1] \
-					+ previous[i][j-1] + previous[i][j+1] \
-					+ previous[i-1][j-1] + previous[i-1][j] + previous[i-1][j+1];
-				if (nbrs == 3 || ( previous[i][j]+nbrs == 3))
-					current[i][j] = 1;
-				else 
-					current[i][j] = 0;
+				nbrs = down[j+1] + down[j] + down[j-1] \
+					+ mid[j-1] + mid[j+1] \
+					+ up[j-1] + up[j] + up[j+1];
+				out[j] = (nbrs == 3) | (mid[j]+nbrs == 3);
 			}
+		}
 	
 		#ifdef OUTPUT
 		print_to_pgm(current, N, t+1);
@@ -130,8 +166,8 @@ int main (int argc, char * argv[]) {
 	gettimeofday(&tf,NULL);
 	time = (tf.tv_sec-ts.tv_sec)+(tf.tv_usec-ts.tv_usec)*0.000001;
 
-	free_array(current, N);
-	free_array(previous, N);
+	free_array(&a);
+	free_array(&b);
 	printf("GameOfLife: Size %d Steps %d Time %lf\n", N, T, time);
 	#ifdef OUTPUT
 	system(FINALIZE);
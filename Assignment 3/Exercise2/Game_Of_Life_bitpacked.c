@@ -0,0 +1,274 @@
+/******************************************************
+ ******** Conway's game of life, bit-packed ***********
+ ******************************************************
+
+ Usage: ./exec ArraySize TimeSteps NumThreads
+
+ Same rules, boundary and initial pattern as
+ Game_Of_Life.c, but 64 cells are packed into each
+ uint64_t and a whole word of cells is computed at
+ once: the eight neighbour counts are added with
+ bitwise full adders, one bit position per cell.
+ That is 32x less memory than an int per cell.
+
+ Compile with -fopenmp, and with -mavx2 (or
+ -march=native) to compute four words at a time.
+ Compile with -DOUTPUT to print output in output.gif
+ (You will need FFmpeg for that; install it with
+  sudo apt-get install ffmpeg)
+ WARNING: Do not print output for large array sizes!
+          or multiple time steps!
+ ******************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+#include <omp.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define FINALIZE "\
+ffmpeg -y -start_number 0 -i out%d.pgm output.gif\n\
+rm *pgm\n\
+"
+
+/* A grid of N rows. Cell (i, j) is bit j%64 of word j/64 + 1 of row i:
+ * every row has an always-empty word before and after its cells, so the
+ * neighbours of the first and last word can be read like any other.
+ * Rows start on a cache line (the pitch is a multiple of 8 words).
+ */
+typedef struct {
+	int N;
+	int words;		// words with cells per row
+	int pitch;		// words per row, including the empty ones
+	uint64_t * cells;
+} grid;
+
+static uint64_t * row(grid * g, int i) {
+	return g->cells + (size_t)i * g->pitch + 1;
+}
+
+static grid allocate_grid(int N) {
+	grid g;
+	g.N = N;
+	g.words = (N + 63) / 64;
+	g.pitch = (g.words + 2 + 7) / 8 * 8;
+	g.cells = aligned_alloc(64, (size_t)N * g.pitch * sizeof(uint64_t));
+	memset(g.cells, 0, (size_t)N * g.pitch * sizeof(uint64_t));
+	return g;
+}
+
+static void free_grid(grid * g) {
+	free(g->cells);
+}
+
+static void set_cell(grid * g, int i, int j) {
+	row(g, i)[j / 64] |= (uint64_t)1 << (j % 64);
+}
+
+#define SEED 0x5eed
+
+/* counter-based random bits, as in Game_Of_Life.c (splitmix64 finalizer) */
+static uint64_t random_bits(uint64_t counter) {
+	uint64_t z = SEED + counter * 0x9e3779b97f4a7c15ull;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/* same pattern as Game_Of_Life.c for the same N; a row is only written
+ * by one thread, so the rows can be filled in parallel
+ */
+static void init_random(grid * g, int num_threads) {
+	int i, j, N = g->N;
+
+#pragma omp parallel for num_threads(num_threads) private(j) schedule(static)
+	for (i = 1 ; i < N-1 ; i++)
+		for (j = 1 ; j < N-1 ; j++)
+			if (random_bits((uint64_t)i * N + j) < UINT64_MAX / 10)
+				set_cell(g, i, j);
+}
+
+/* the cells of the words that are computed: everything but the first and
+ * last column (and the bits past the last column)
+ */
+static uint64_t * interior_masks(grid * g) {
+	int j;
+	uint64_t * mask = aligned_alloc(64, g->pitch * sizeof(uint64_t));
+	memset(mask, 0, g->pitch * sizeof(uint64_t));
+	for (j = 1 ; j < g->N - 1 ; j++)
+		mask[j / 64] |= (uint64_t)1 << (j % 64);
+	return mask;
+}
+
+/* Next state of the 64 cells in word w of row i, from the word above (up),
+ * the word itself (mid) and the word below (down), each with the words on
+ * both sides for the neighbours across the word boundary.
+ *
+ * The eight neighbour bits of every cell are added with full adders into
+ * a three bit count (ones, twos, fours); a count of 8 wraps to 0, which is
+ * dead as well. A cell lives with 3 neighbours, or with 2 if it was alive.
+ */
+#define WEST(x, prev)	(((x) << 1) | ((prev) >> 63))
+#define EAST(x, next)	(((x) >> 1) | ((next) << 63))
+
+static uint64_t next_word(const uint64_t * up, const uint64_t * mid, const uint64_t * down, int w) {
+	uint64_t a = WEST(up[w], up[w-1]), b = up[w], c = EAST(up[w], up[w+1]);
+	uint64_t d = WEST(mid[w], mid[w-1]), e = EAST(mid[w], mid[w+1]);
+	uint64_t f = WEST(down[w], down[w-1]), g = down[w], h = EAST(down[w], down[w+1]);
+	uint64_t s1, c1, s2, c2, s3, c3, ones, c4, t, c5, twos, c6, fours;
+
+	s1 = a ^ b ^ c;		c1 = (a & b) | (c & (a ^ b));
+	s2 = d ^ e ^ f;		c2 = (d & e) | (f & (d ^ e));
+	s3 = g ^ h;		c3 = g & h;
+	ones = s1 ^ s2 ^ s3;	c4 = (s1 & s2) | (s3 & (s1 ^ s2));
+	t = c1 ^ c2 ^ c3;	c5 = (c1 & c2) | (c3 & (c1 ^ c2));
+	twos = t ^ c4;		c6 = t & c4;
+	fours = c5 ^ c6;
+
+	return twos & ~fours & (ones | mid[w]);
+}
+
+#ifdef __AVX2__
+/* next_word for words w .. w+3 */
+#define WEST4(x, prev)	_mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(prev, 63))
+#define EAST4(x, next)	_mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(next, 63))
+#define LOAD4(p)	_mm256_loadu_si256((const __m256i *)(p))
+#define XOR(x, y)	_mm256_xor_si256(x, y)
+#define AND(x, y)	_mm256_and_si256(x, y)
+#define OR(x, y)	_mm256_or_si256(x, y)
+
+static __m256i next_words4(const uint64_t * up, const uint64_t * mid, const uint64_t * down, int w) {
+	__m256i u = LOAD4(up + w), m = LOAD4(mid + w), l = LOAD4(down + w);
+	__m256i a = WEST4(u, LOAD4(up + w - 1)), b = u, c = EAST4(u, LOAD4(up + w + 1));
+	__m256i d = WEST4(m, LOAD4(mid + w - 1)), e = EAST4(m, LOAD4(mid + w + 1));
+	__m256i f = WEST4(l, LOAD4(down + w - 1)), g = l, h = EAST4(l, LOAD4(down + w + 1));
+	__m256i s1, c1, s2, c2, s3, c3, ones, c4, t, c5, twos, c6, fours;
+
+	s1 = XOR(XOR(a, b), c);		c1 = OR(AND(a, b), AND(c, XOR(a, b)));
+	s2 = XOR(XOR(d, e), f);		c2 = OR(AND(d, e), AND(f, XOR(d, e)));
+	s3 = XOR(g, h);			c3 = AND(g, h);
+	ones = XOR(XOR(s1, s2), s3);	c4 = OR(AND(s1, s2), AND(s3, XOR(s1, s2)));
+	t = XOR(XOR(c1, c2), c3);	c5 = OR(AND(c1, c2), AND(c3, XOR(c1, c2)));
+	twos = XOR(t, c4);		c6 = AND(t, c4);
+	fours = XOR(c5, c6);
+
+	return _mm256_andnot_si256(fours, AND(twos, OR(ones, m)));
+}
+#endif
+
+/* compute row i of current from previous */
+static void next_row(grid * current, grid * previous, const uint64_t * mask, int i) {
+	const uint64_t * up = row(previous, i-1);
+	const uint64_t * mid = row(previous, i);
+	const uint64_t * down = row(previous, i+1);
+	uint64_t * out = row(current, i);
+	int w = 0;
+
+#ifdef __AVX2__
+	for ( ; w + 4 <= previous->words ; w += 4)
+		_mm256_storeu_si256((__m256i *)(out + w), AND(next_words4(up, mid, down, w), LOAD4(mask + w)));
+#endif
+	for ( ; w < previous->words ; w++)
+		out[w] = next_word(up, mid, down, w) & mask[w];
+}
+
+#ifdef OUTPUT
+static int get_cell(grid * g, int i, int j) {
+	return (row(g, i)[j / 64] >> (j % 64)) & 1;
+}
+
+static void print_to_pgm(grid * g, int t) {
+	int i, j, N = g->N;
+	char * s = malloc(30*sizeof(char));
+	sprintf(s, "out%d.pgm", t);
+	FILE * f = fopen(s, "wb");
+	fprintf(f, "P5\n%d %d 1\n", N,N);
+	for (i = 0; i < N ; i++)
+		for (j = 0; j < N ; j++)
+			fputc(get_cell(g, i, j), f);
+	fclose(f);
+	free(s);
+}
+#endif
+
+/* number of living cells */
+static long population(grid * g) {
+	long count = 0;
+	int i, w;
+	for (i = 0 ; i < g->N ; i++)
+		for (w = 0 ; w < g->words ; w++)
+			count += __builtin_popcountll(row(g, i)[w]);
+	return count;
+}
+
+int main (int argc, char * argv[]) {
+	int N;	 			//array dimensions
+	int T; 				//time steps
+	grid a, b;			//grids - one for current timestep, one for previous timestep
+	grid * current, * previous;
+	grid * swap;			//grid pointer
+	uint64_t * mask;		//cells to compute in each word of a row
+	int t, i;			//helper variables
+	int num_threads;		// num of threads to run with
+
+	double time;			//variables for timing
+	struct timeval ts,tf;
+
+	/*Read input arguments*/
+	if (argc != 4) {
+		fprintf(stderr, "Usage: ./exec ArraySize TimeSteps NumThreads\n");
+		exit(-1);
+	}
+	else {
+		N = atoi(argv[1]);
+		T = atoi(argv[2]);
+		num_threads = atoi(argv[3]);
+	}
+
+	/*Allocate and initialize grids*/
+	a = allocate_grid(N);
+	b = allocate_grid(N);
+	current = &a;
+	previous = &b;
+	mask = interior_masks(previous);
+
+	init_random(previous, num_threads);			//initialize previous grid with pattern
+
+	#ifdef OUTPUT
+	print_to_pgm(previous, 0);
+	#endif
+
+	/*Game of Life*/
+
+	gettimeofday(&ts,NULL);
+	for (t = 0 ; t < T ; t++) {
+#pragma omp parallel for num_threads(num_threads) private(i) schedule(static)
+		for (i = 1 ; i < N-1 ; i++)
+			next_row(current, previous, mask, i);
+
+		#ifdef OUTPUT
+		print_to_pgm(current, t+1);
+		#endif
+		//Swap current grid with previous grid
+		swap = current;
+		current = previous;
+		previous = swap;
+
+	}
+	gettimeofday(&tf,NULL);
+	time = (tf.tv_sec-ts.tv_sec)+(tf.tv_usec-ts.tv_usec)*0.000001;
+
+	printf("GameOfLife (bit-packed): Size %d Steps %d Time %lf Population %ld\n", N, T, time, population(previous));
+	free_grid(&a);
+	free_grid(&b);
+	free(mask);
+	#ifdef OUTPUT
+	system(FINALIZE);
+	#endif
+	return 0;
+}
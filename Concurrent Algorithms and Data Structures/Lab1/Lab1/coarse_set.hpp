@@ -14,15 +14,18 @@ struct CoarseSetNode {
 };
 
 /// A set implementation using a linked list with coarse grained locking.
+/// `Lock` can be `std::mutex` or one of the locks in `locks.hpp` and
+/// `cohort_locks.hpp`.
+template <typename Lock = std::mutex>
 class CoarseSet: public Set {
 private:
     // A03: You can add or remove fields as needed. Just having the `head`
     // pointer and the `lock` should be sufficient for task 3
     CoarseSetNode* head;
-    std::mutex lock;
-    EventMonitor<CoarseSet, StdSet, SetOperator>* monitor;
+    Lock lock;
+    EventMonitor<CoarseSet<Lock>, StdSet, SetOperator>* monitor;
 public:
-    CoarseSet(EventMonitor<CoarseSet, StdSet, SetOperator>* monitor) :
+    CoarseSet(EventMonitor<CoarseSet<Lock>, StdSet, SetOperator>* monitor) :
         head(nullptr), monitor(monitor)
     {
         // A03: Initiate the internal state
@@ -7,22 +7,25 @@
 
 /// The node used for the linked list implementation of a set in the [`FineSet`]
 /// class. This struct is used for task 4.
+template <typename Lock = std::mutex>
 struct FineSetNode {
     // A04: You can add or remove fields as needed.
     int value;
     FineSetNode* next;
-    std::mutex lock;
+    Lock lock;
 };
 
 /// A set implementation using a linked list with fine grained locking.
+/// `Lock` is the lock of every node, e.g. `std::mutex` or `FutexMutex`.
+template <typename Lock = std::mutex>
 class FineSet: public Set {
 private:
     // A04: You can add or remove fields as needed. Just having the `head`
     // pointer should be sufficient for task 4
-    FineSetNode* head;
-    EventMonitor<FineSet, StdSet, SetOperator>* monitor;
+    FineSetNode<Lock>* head;
+    EventMonitor<FineSet<Lock>, StdSet, SetOperator>* monitor;
 public:
-    FineSet(EventMonitor<FineSet, StdSet, SetOperator>* monitor) :
+    FineSet(EventMonitor<FineSet<Lock>, StdSet, SetOperator>* monitor) :
         head(nullptr), monitor(monitor)
     {
         // A04: Initiate the internal state
@@ -30,9 +33,9 @@ public:
 
     ~FineSet() override {
         // A04: Cleanup any memory that was allocated
-        FineSetNode* current = head;
+        FineSetNode<Lock>* current = head;
         while (current != nullptr) {
-            FineSetNode* next = current->next;
+            FineSetNode<Lock>* next = current->next;
             delete current;
             current = next;
         }
@@ -47,7 +50,7 @@ public:
 
         // First we check the head, to see if it's empty
         if (head == nullptr) {
-            FineSetNode* addedNode = new FineSetNode{ elem, nullptr };
+            FineSetNode<Lock>* addedNode = new FineSetNode<Lock>{ elem, nullptr };
             addedNode->lock.lock();
             head = addedNode;
             head->next = nullptr;
@@ -55,7 +58,7 @@ public:
         }
         else {
             // we get to the last element of the list while checking if elem is already in the list
-            FineSetNode* current = head;
+            FineSetNode<Lock>* current = head;
             current->lock.lock();
             while (current->next != nullptr) {                
                 if (current->value == elem) {
@@ -63,7 +66,7 @@ public:
                     current->lock.unlock();
                     break;
                 }
-                FineSetNode* next = current->next;
+                FineSetNode<Lock>* next = current->next;
                 next->lock.lock();
                 current->lock.unlock();
                 current = next;
@@ -76,7 +79,7 @@ public:
             // if we got to the last node and elem is not in the list, we create and add a new node wiht
             // elem, and link the previous last node to this one
             if (result) {
-                FineSetNode* addedNode = new FineSetNode{ elem, nullptr };
+                FineSetNode<Lock>* addedNode = new FineSetNode<Lock>{ elem, nullptr };
                 addedNode->lock.lock();
                 current->next = addedNode;
                 current->lock.unlock();
@@ -100,7 +103,7 @@ public:
             if (head->next != nullptr) {
                 head->next->lock.lock();
             }            
-            FineSetNode* temp = head;
+            FineSetNode<Lock>* temp = head;
             head = head->next;
             delete temp;
             if (head != nullptr) {
@@ -110,8 +113,8 @@ public:
         }
         else {
             // we get to the last element of the list while checking if elem is already in the list
-            FineSetNode* current = head;            
-            FineSetNode* previous = nullptr;
+            FineSetNode<Lock>* current = head;            
+            FineSetNode<Lock>* previous = nullptr;
             while (current != nullptr) {
                 current->lock.lock();
                 if (current->value == elem) {
@@ -154,7 +157,7 @@ public:
         //      the linearization point.
 
          // We iterate over the linked list and check for elem
-        FineSetNode* current = head;        
+        FineSetNode<Lock>* current = head;        
         while (current != nullptr) {
             current->lock.lock();
             if (current->value == elem) {
@@ -162,7 +165,7 @@ public:
                 current->lock.unlock();
                 break;
             }
-            FineSetNode* next = current->next;
+            FineSetNode<Lock>* next = current->next;
             current->lock.unlock();
             current = next;
         }
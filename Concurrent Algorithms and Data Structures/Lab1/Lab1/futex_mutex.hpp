@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "locks.hpp"
+
+/// Sleeps while `*addr == expected`. Without futexes (e.g. on Windows) this
+/// just yields, which the callers handle like a spurious wakeup.
+inline void futex_wait(std::atomic<int>* addr, int expected) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    (void)addr;
+    (void)expected;
+    std::this_thread::yield();
+#endif
+}
+
+/// Wakes up to `count` threads sleeping on `addr`.
+inline void futex_wake(std::atomic<int>* addr, int count) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+    (void)addr;
+    (void)count;
+#endif
+}
+
+/// Contention counters of one lock. When a counted lock is destroyed its
+/// counts are added to `FutexStats::total()`, so the counts of all the node
+/// locks of a set can be read after the set is gone.
+struct FutexStats {
+    /// Acquisitions that got the lock with the first compare-and-swap
+    std::atomic<long> fast_path{0};
+    /// Failed compare-and-swaps while spinning before going to sleep
+    std::atomic<long> spins{0};
+    /// `futex_wait` calls, i.e. times a thread went to sleep
+    std::atomic<long> waits{0};
+    /// `futex_wake` calls
+    std::atomic<long> wakes{0};
+
+    void add_to(FutexStats& other) const {
+        other.fast_path += fast_path.load(std::memory_order_relaxed);
+        other.spins += spins.load(std::memory_order_relaxed);
+        other.waits += waits.load(std::memory_order_relaxed);
+        other.wakes += wakes.load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        fast_path = 0;
+        spins = 0;
+        waits = 0;
+        wakes = 0;
+    }
+
+    static FutexStats& total() {
+        static FutexStats stats;
+        return stats;
+    }
+};
+
+/// The counters of a counted lock, a base class so that the uncounted
+/// specialization below takes no space in the lock.
+template <bool Counted>
+class FutexCounters {
+    FutexStats counters;
+
+protected:
+    FutexCounters() = default;
+
+    ~FutexCounters() {
+        counters.add_to(FutexStats::total());
+    }
+
+    void count(std::atomic<long> FutexStats::*counter) {
+        (counters.*counter).fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    const FutexStats& stats() const {
+        return counters;
+    }
+};
+
+template <>
+class FutexCounters<false> {
+protected:
+    void count(std::atomic<long> FutexStats::*) {
+    }
+
+public:
+    /// Always zero
+    const FutexStats& stats() const {
+        static const FutexStats none;
+        return none;
+    }
+};
+
+/// A mutex on a Linux futex, the three state mutex from Drepper's "Futexes
+/// Are Tricky": 0 is unlocked, 1 locked and 2 locked with possible sleepers.
+/// `unlock` only makes a system call in state 2. Before sleeping, `lock` spins
+/// for a short while, which is enough when critical sections are short.
+///
+/// With `Counted = true` the lock keeps `FutexStats`, otherwise the counters
+/// compile to nothing and the lock is as small as its state. It can be used
+/// wherever `std::mutex` is.
+template <bool Counted>
+class BasicFutexMutex : public FutexCounters<Counted> {
+    static const int SPINS = 100;
+    std::atomic<int> state{0};
+
+    using FutexCounters<Counted>::count;
+
+public:
+    BasicFutexMutex() = default;
+    BasicFutexMutex(const BasicFutexMutex&) = delete;
+    BasicFutexMutex& operator=(const BasicFutexMutex&) = delete;
+
+    void lock() {
+        int c = 0;
+        if (state.compare_exchange_strong(c, 1, std::memory_order_acquire)) {
+            count(&FutexStats::fast_path);
+            return;
+        }
+        for (int i = 0; i < SPINS && c != 2; i++) {
+            cpu_relax();
+            c = 0;
+            if (state.compare_exchange_strong(c, 1, std::memory_order_acquire)) {
+                return;
+            }
+            count(&FutexStats::spins);
+        }
+        // Mark the lock as contended; whoever unlocks it has to wake someone
+        if (c != 2) {
+            c = state.exchange(2, std::memory_order_acquire);
+        }
+        while (c != 0) {
+            count(&FutexStats::waits);
+            futex_wait(&state, 2);
+            c = state.exchange(2, std::memory_order_acquire);
+        }
+    }
+
+    bool try_lock() {
+        int c = 0;
+        return state.compare_exchange_strong(c, 1, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        if (state.fetch_sub(1, std::memory_order_release) != 1) {
+            state.store(0, std::memory_order_release);
+            count(&FutexStats::wakes);
+            futex_wake(&state, 1);
+        }
+    }
+};
+
+typedef BasicFutexMutex<false> FutexMutex;
+typedef BasicFutexMutex<true> CountedFutexMutex;
+
+/// A condition variable on a futex. Waiters sleep on a sequence number that
+/// every notify increments, so a notify between unlocking the mutex and
+/// going to sleep is not lost. Works with any lock, like
+/// `std::condition_variable_any`.
+template <bool Counted>
+class BasicFutexCondition : public FutexCounters<Counted> {
+    std::atomic<int> sequence{0};
+
+    using FutexCounters<Counted>::count;
+
+public:
+    BasicFutexCondition() = default;
+    BasicFutexCondition(const BasicFutexCondition&) = delete;
+    BasicFutexCondition& operator=(const BasicFutexCondition&) = delete;
+
+    template <typename Lock>
+    void wait(Lock& lock) {
+        int seq = sequence.load(std::memory_order_relaxed);
+        lock.unlock();
+        count(&FutexStats::waits);
+        futex_wait(&sequence, seq);
+        lock.lock();
+    }
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate done) {
+        while (!done()) {
+            wait(lock);
+        }
+    }
+
+    void notify_one() {
+        sequence.fetch_add(1, std::memory_order_relaxed);
+        count(&FutexStats::wakes);
+        futex_wake(&sequence, 1);
+    }
+
+    void notify_all() {
+        sequence.fetch_add(1, std::memory_order_relaxed);
+        count(&FutexStats::wakes);
+        futex_wake(&sequence, INT_MAX);
+    }
+};
+
+typedef BasicFutexCondition<false> FutexCondition;
+typedef BasicFutexCondition<true> CountedFutexCondition;
@@ -2,8 +2,10 @@
 #include "std_set.hpp"
 #include "simple_set.hpp"
 #include "coarse_set.hpp"
+#include "cohort_locks.hpp"
 #include "fine_set.hpp"
 #include "optimistic_set.hpp"
+#include "futex_mutex.hpp"
 
 
 #include <stdio.h>
@@ -171,7 +173,7 @@ int task_3() {
 
     for (int test_run = 0; test_run < 8; test_run++) {
         std::cout << "## Testing `CoarseSet` with 4 thread and seed: " << test_run << std::endl;
-        valid &= test_set_n_threads<CoarseSet>(4, DEFAULT_OP_MOD);
+        valid &= test_set_n_threads<CoarseSet<>>(4, DEFAULT_OP_MOD);
         std::cout << std::endl;
 
         if (!valid) {
@@ -193,7 +195,7 @@ int task_4() {
 
     for (int test_run = 0; test_run < 8; test_run++) {
         std::cout << "## Testing `FineSet` with 4 thread and seed: " << test_run << std::endl;
-        valid &= test_set_n_threads<FineSet>(4, DEFAULT_OP_MOD);
+        valid &= test_set_n_threads<FineSet<>>(4, DEFAULT_OP_MOD);
         std::cout << std::endl;
 
         if (!valid) {
@@ -231,6 +233,108 @@ int task_5() {
     }
 }
 
+/// Tests `CoarseSet` with the NUMA-aware cohort locks
+int task_6() {
+    bool valid = true;
+    std::cout << "# Task 6: Coarse Set with cohort locks" << std::endl;
+    std::cout << "NUMA nodes: " << numa_topology::get().node_count() << std::endl;
+
+    for (int test_run = 0; test_run < 8 && valid; test_run++) {
+        std::cout << "## Testing `CoarseSet<c_tkt_tkt_lock>` with 4 thread and seed: " << test_run << std::endl;
+        valid &= test_set_n_threads<CoarseSet<c_tkt_tkt_lock>>(4, DEFAULT_OP_MOD);
+        std::cout << std::endl;
+
+        std::cout << "## Testing `CoarseSet<c_mcs_mcs_lock>` with 4 thread and seed: " << test_run << std::endl;
+        valid &= test_set_n_threads<CoarseSet<c_mcs_mcs_lock>>(4, DEFAULT_OP_MOD);
+        std::cout << std::endl;
+    }
+
+    if (valid) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
+
+void print_futex_stats(char const* name) {
+    FutexStats& stats = FutexStats::total();
+    std::cout << "- " << name
+        << ": fast path " << stats.fast_path
+        << ", spins " << stats.spins
+        << ", futex waits " << stats.waits
+        << ", futex wakes " << stats.wakes << std::endl;
+    stats.reset();
+}
+
+/// Tests the sets and the monitor with the futex mutex and prints how often
+/// the locks were contended
+int task_7() {
+    bool valid = true;
+    std::cout << "# Task 7: Futex mutex" << std::endl;
+
+    for (int test_run = 0; test_run < 8 && valid; test_run++) {
+        std::cout << "## Testing `CoarseSet<CountedFutexMutex>` with 4 thread and seed: " << test_run << std::endl;
+        FutexStats::total().reset();
+        valid &= test_set_n_threads<CoarseSet<CountedFutexMutex>>(4, DEFAULT_OP_MOD);
+        print_futex_stats("set lock");
+        std::cout << std::endl;
+    }
+
+    if (valid) {
+        // The monitor lock: one thread applies operations to a `StdSet` and
+        // hands the events to the monitor thread
+        std::cout << "## Testing `EventMonitor` with `CountedFutexMutex`" << std::endl;
+        StdSet worker_set;
+        StdSet test_set;
+        {
+            EventMonitor<StdSet, StdSet, SetOperator, CountedFutexMutex> monitor(&test_set);
+            monitor.set_concurrent_data_structure(&worker_set);
+            OpGenerator<SetOperator> generator(DEFAULT_SET_GEN_WEIGHTS, OPERATION_COUNT, DEFAULT_OP_MOD, DEFAULT_GENERATOR_SEED);
+            std::thread monitor_thread([&monitor]() { monitor.monitor(); });
+            while (auto maybe_operation = generator.next()) {
+                SetOperation operation = maybe_operation.value();
+                bool result = apply_op(&worker_set, operation);
+                monitor.add(SetEvent(operation.op, operation.argument, result));
+            }
+            monitor.finish();
+            monitor_thread.join();
+            valid &= monitor.is_valid();
+        }
+        print_futex_stats("monitor lock");
+        std::cout << std::endl;
+    }
+
+    if (valid) {
+        // The condition variable: two threads take turns
+        std::cout << "## Ping-pong with `CountedFutexCondition`" << std::endl;
+        {
+            CountedFutexMutex mutex;
+            CountedFutexCondition turn_changed;
+            int turn = 0;
+            const int rounds = 1000;
+            auto player = [&](int me) {
+                for (int i = 0; i < rounds; i++) {
+                    std::unique_lock<CountedFutexMutex> guard(mutex);
+                    turn_changed.wait(guard, [&]() { return turn == me; });
+                    turn = 1 - me;
+                    turn_changed.notify_one();
+                }
+            };
+            std::thread ping(player, 0);
+            std::thread pong(player, 1);
+            ping.join();
+            pong.join();
+        }
+        print_futex_stats("ping-pong mutex and condition");
+    }
+
+    if (valid) {
+        return 0;
+    } else {
+        return -1;
+    }
+}
+
 struct ExpectedOperation {
     Operation<SetOperator> operation;
     bool expectedResult;
@@ -320,6 +424,10 @@ int main(int argc, char* argv[]) {
             return task_4();
         case 5:
             return task_5();
+        case 6:
+            return task_6();
+        case 7:
+            return task_7();
         case 11:
             return task_11();
         default:
@@ -197,7 +197,11 @@ bool test_events(DS* data_structure, std::queue<Event<Op>>* events, bool verbose
 /// This class uses coarse grained locking, because this is the simplest thing
 /// to implement. During the course you'll learn about more efficient algorithms
 /// for concurrent data structures.
-template<typename CAS, typename DS, typename Op>
+///
+/// `Lock` protects the event queue; it can be any lock with the interface of
+/// `std::mutex`, e.g. `CountedFutexMutex` to see how often the workers and the
+/// monitor thread collide.
+template<typename CAS, typename DS, typename Op, typename Lock = std::mutex>
 class EventMonitor {
 public:
     EventMonitor(DS* data_structure) :
@@ -275,7 +279,7 @@ public:
 
 private:
     std::queue<Event<Op>> events_to_test;
-    std::mutex lock;
+    Lock lock;
 
     // For monitoring and validation
     DS* data_structure;
@@ -65,9 +65,9 @@ namespace bench {
     template <class Set>
     void run_config(char const* set_name, BenchConfig& config) {
         std::vector<OpWeights<SetOperator>> op_weights = {
-            OpWeights<SetOperator> {op: SetOperator::Add, weight: config.ctn_weight},
-            OpWeights<SetOperator> {op: SetOperator::Remove, weight: config.get_add_weight()},
-            OpWeights<SetOperator> {op: SetOperator::Contains, weight: config.get_rmv_weight()},
+            OpWeights<SetOperator> {op: SetOperator::Add, weight: config.get_add_weight()},
+            OpWeights<SetOperator> {op: SetOperator::Remove, weight: config.get_rmv_weight()},
+            OpWeights<SetOperator> {op: SetOperator::Contains, weight: config.ctn_weight},
         };
         OpGenerator<SetOperator>** generators = new OpGenerator<SetOperator>*[config.threads];
         for (int i = 0; i < config.threads; i++) {
@@ -82,7 +82,7 @@ namespace bench {
         print_table_row(set_name, config, end - start);
 
         for (int i = 0; i < config.threads; i++) {
-            delete[] generators[i];
+            delete generators[i];
         }
         delete[] generators;
     }
@@ -9,28 +9,30 @@
 // remove all references to the monitor. We want to benchmark the data
 // structure and monitoring the performed operation would influence the
 // results.
+template <typename Lock = std::mutex>
 struct FineSetNode {
     // A04: You can add or remove fields as needed.
     int value;
     FineSetNode* next;
-    std::mutex lock;
+    Lock lock;
     FineSetNode(int elem, FineSetNode* next_node = NULL) {
         value = elem;
         next = next_node;
     }
 };
+template <typename Lock = std::mutex>
 class FineSet : public Set {
 private:
-    FineSetNode* head;
+    FineSetNode<Lock>* head;
 public:
     FineSet() {
-        head = new FineSetNode(INT_MIN);
-        head->next = new FineSetNode(INT_MAX);
+        head = new FineSetNode<Lock>(INT_MIN);
+        head->next = new FineSetNode<Lock>(INT_MAX);
     }
 
     ~FineSet() {
         while (head != NULL) {
-            FineSetNode* temp = head;
+            FineSetNode<Lock>* temp = head;
             head = head->next;
             delete temp;
         }
@@ -39,7 +41,7 @@ public:
     bool add(int elem) override {
         bool result = false;
         head->lock.lock();
-        FineSetNode* prev = head, * curr = head->next;
+        FineSetNode<Lock>* prev = head, * curr = head->next;
         curr->lock.lock();
         while (curr->value < elem) {
             prev->lock.unlock();
@@ -48,7 +50,7 @@ public:
             curr->lock.lock();
         }
         if (curr->value != elem) {
-            prev->next = new FineSetNode(elem, curr);
+            prev->next = new FineSetNode<Lock>(elem, curr);
             result = true;
         }
         prev->lock.unlock();
@@ -59,7 +61,7 @@ public:
     bool rmv(int elem) override {
         bool result = false;
         head->lock.lock();
-        FineSetNode* prev = head, * curr = head->next;
+        FineSetNode<Lock>* prev = head, * curr = head->next;
         curr->lock.lock();
         while (curr->value < elem) {
             prev->lock.unlock();
@@ -80,7 +82,7 @@ public:
     bool ctn(int elem) override {
         bool result = false;
         head->lock.lock();
-        FineSetNode* prev = head, * curr = head->next;
+        FineSetNode<Lock>* prev = head, * curr = head->next;
         curr->lock.lock();
         while (curr->value < elem) {
             prev->lock.unlock();
@@ -7,20 +7,22 @@
 
 /// The node used for the linked list implementation of a set in the [`LazySet`]
 /// class. This struct is used for task 3
+template <typename Lock = std::mutex>
 struct LazySetNode {
     // A02: You can add or remove fields as needed.
     int value;
     bool mark;
     LazySetNode* next;
-    std::mutex lock;
+    Lock lock;
 };
 
 /// A set implementation using a linked list with optimistic syncronization.
+template <typename Lock = std::mutex>
 class LazySet: public Set {
 private:
     // A02: You can add or remove fields as needed. Just having the `head`
     // pointer should be sufficient for this task
-    LazySetNode* head;
+    LazySetNode<Lock>* head;
 public:
     LazySet() : head(nullptr)
     {
@@ -29,21 +31,21 @@ public:
 
     ~LazySet() override {
         // A02: Cleanup any memory that was allocated
-        LazySetNode* current = head;
+        LazySetNode<Lock>* current = head;
         while (current != nullptr) {
-            LazySetNode* next = current->next;
+            LazySetNode<Lock>* next = current->next;
             delete current;
             current = next;
         }
     }
 
 private:
-    std::pair<LazySetNode*, LazySetNode*> locate(int value) {
+    std::pair<LazySetNode<Lock>*, LazySetNode<Lock>*> locate(int value) {
         // A02: Implement the `locate` function used for lazy synchronization.
 
         while (true) {
-            LazySetNode* p = nullptr;
-            LazySetNode* c = head;
+            LazySetNode<Lock>* p = nullptr;
+            LazySetNode<Lock>* c = head;
             // empty list case, we return null for both.
             if (c == nullptr) {       
                 return std::make_pair(nullptr, nullptr);
@@ -90,8 +92,8 @@ public:
         bool result = false;
         // A02: Add code to insert the element into the set and update `result`.
 
-        LazySetNode* p = nullptr;
-        LazySetNode* c = nullptr;
+        LazySetNode<Lock>* p = nullptr;
+        LazySetNode<Lock>* c = nullptr;
         std::tie(p, c) = locate(elem);
         if (c && c->value == elem) {
             if (p) p->lock.unlock();
@@ -100,7 +102,7 @@ public:
         }
         else {
             result = true;
-            LazySetNode* newNode = new LazySetNode{ elem, false, nullptr };
+            LazySetNode<Lock>* newNode = new LazySetNode<Lock>{ elem, false, nullptr };
             if (!p && !c) {
                 head = newNode;
             }
@@ -120,8 +122,8 @@ public:
         bool result = false;
         // A02: Add code to remove the element from the set and update `result`.
 
-        LazySetNode* p = nullptr;
-        LazySetNode* c = nullptr;
+        LazySetNode<Lock>* p = nullptr;
+        LazySetNode<Lock>* c = nullptr;
         std::tie(p, c) = locate(elem);
         if (c && c->value == elem) {
             c->mark = true;
@@ -148,8 +150,8 @@ public:
         bool result = false;
         // A01: Add code to check if the element is inside the set and update `result`.
 
-        LazySetNode* p = nullptr;
-        LazySetNode* c = head;
+        LazySetNode<Lock>* p = nullptr;
+        LazySetNode<Lock>* c = head;
 
         while (c) {
             c->lock.lock();
@@ -172,7 +174,7 @@ public:
     void print_state() override {
         // A02: Optionally, add code to print the state. This is useful for debugging,
         // but not part of the assignment
-        LazySetNode* c = head;
+        LazySetNode<Lock>* c = head;
         std::cout << "LazySet { ";
         while (c != nullptr) {
             std::cout << c->value << " ";
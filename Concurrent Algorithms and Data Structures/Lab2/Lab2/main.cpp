@@ -7,6 +7,10 @@
 #include "optimistic_set.hpp"
 #include "std_multiset.hpp"
 #include "fine_multiset.hpp"
+#include "futex_mutex.hpp"
+#include "locks.hpp"
+#include "rw_coarse_set.hpp"
+#include "rw_locks.hpp"
 
 #include <stdio.h>
 #include <cstring>
@@ -128,7 +132,7 @@ int task_1() {
     std::cout << "# Task 1: OptimisticSet" << std::endl;
     std::cout << std::endl;
 
-    return test_set_implementation<OptimisticSet>("OptimisticSet");
+    return test_set_implementation<OptimisticSet<>>("OptimisticSet");
 }
 
 int task_2() {
@@ -136,7 +140,7 @@ int task_2() {
     std::cout << "# Task 2: LazySet" << std::endl;
     std::cout << std::endl;
 
-    return test_set_implementation<LazySet>("LazySet");
+    return test_set_implementation<LazySet<>>("LazySet");
 }
 
 int task_3() {
@@ -144,15 +148,15 @@ int task_3() {
     std::cout << "# Task 3: FineSet" << std::endl;
     std::cout << std::endl;
 
-    return test_set_implementation<FineSet>("FineSet");
+    return test_set_implementation<FineSet<>>("FineSet");
 }
 
 int task_4() {
     std::cout << "# Task 4: Benchmarking" << std::endl;
     std::cout << std::endl;
-    bench::benchmark_set<OptimisticSet>("OptimisticSet");
-    bench::benchmark_set<LazySet>("LazySet");
-    bench::benchmark_set<FineSet>("FineSet");
+    bench::benchmark_set<OptimisticSet<>>("OptimisticSet");
+    bench::benchmark_set<LazySet<>>("LazySet");
+    bench::benchmark_set<FineSet<>>("FineSet");
 
     return 0;
 }
@@ -178,6 +182,47 @@ int task_5() {
     }
 }
 
+int task_6() {
+    std::cout << "# Task 6: Benchmarking `FineSet` with different locks" << std::endl;
+    std::cout << std::endl;
+    bench::benchmark_set<FineSet<std::mutex>>("std::mutex");
+    bench::benchmark_set<FineSet<tas_lock>>("tas");
+    bench::benchmark_set<FineSet<ttas_lock>>("ttas+backoff");
+    bench::benchmark_set<FineSet<ticket_lock>>("ticket");
+    bench::benchmark_set<FineSet<mcs_lock>>("mcs");
+    bench::benchmark_set<FineSet<clh_lock>>("clh");
+    bench::benchmark_set<FineSet<spin_then_park_lock>>("spin-then-park");
+    bench::benchmark_set<FineSet<CountedFutexMutex>>("futex");
+    FutexStats& stats = FutexStats::total();
+    std::cout << "futex node locks: fast path " << stats.fast_path
+        << ", spins " << stats.spins
+        << ", futex waits " << stats.waits
+        << ", futex wakes " << stats.wakes << std::endl;
+
+    return 0;
+}
+
+int task_7() {
+    std::cout << "# Task 7: `RwCoarseSet` with different reader-writer locks" << std::endl;
+    std::cout << std::endl;
+
+    bool valid = test_rw_lock_try_lock<phase_fair_rw_lock>("phase_fair_rw_lock");
+    valid &= test_rw_lock_try_lock<bravo_rw_lock<>>("bravo_rw_lock");
+    valid &= test_rw_lock_mixed<phase_fair_rw_lock>("phase_fair_rw_lock");
+    valid &= test_rw_lock_mixed<bravo_rw_lock<>>("bravo_rw_lock");
+    valid &= test_set_implementation<RwCoarseSet<phase_fair_rw_lock>>("RwCoarseSet<phase_fair_rw_lock>") == 0;
+    valid &= test_set_implementation<RwCoarseSet<bravo_rw_lock<>>>("RwCoarseSet<bravo_rw_lock>") == 0;
+    if (!valid) {
+        return -1;
+    }
+
+    bench::benchmark_set<RwCoarseSet<std::shared_mutex>>("shared_mutex");
+    bench::benchmark_set<RwCoarseSet<phase_fair_rw_lock>>("phase-fair");
+    bench::benchmark_set<RwCoarseSet<bravo_rw_lock<>>>("bravo");
+
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // Input validation
     if (argc < 2) {
@@ -206,6 +251,10 @@ int main(int argc, char* argv[]) {
             return task_4();
         case 5:
             return task_5();
+        case 6:
+            return task_6();
+        case 7:
+            return task_7();
         default:
             fprintf(stderr, "Please enter a valid task, as the first argument\n");
             return -1;
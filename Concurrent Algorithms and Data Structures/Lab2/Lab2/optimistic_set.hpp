@@ -7,19 +7,21 @@
 
 /// The node used for the linked list implementation of a set in the [`OptimisticSet`]
 /// class. This struct is used for task 3
+template <typename Lock = std::mutex>
 struct OptimisticSetNode {
     // A01: You can add or remove fields as needed.
     int value;
     OptimisticSetNode* next;
-    std::mutex lock;
+    Lock lock;
 };
 
 /// A set implementation using a linked list with optimistic syncronization.
+template <typename Lock = std::mutex>
 class OptimisticSet: public Set {
 private:
     // A01: You can add or remove fields as needed. Just having the `head`
     // pointer should be sufficient for this task
-    OptimisticSetNode* head;
+    OptimisticSetNode<Lock>* head;
 public:
     OptimisticSet() : head(nullptr)
     {
@@ -28,21 +30,21 @@ public:
 
     ~OptimisticSet() override {
         // A01: Cleanup any memory that was allocated
-        OptimisticSetNode* current = head;
+        OptimisticSetNode<Lock>* current = head;
         while (current != nullptr) {
-            OptimisticSetNode* next = current->next;
+            OptimisticSetNode<Lock>* next = current->next;
             delete current;
             current = next;
         }
     }
 
 private:
-    bool validate(OptimisticSetNode* p, OptimisticSetNode* c) {
+    bool validate(OptimisticSetNode<Lock>* p, OptimisticSetNode<Lock>* c) {
         // A01: Implement the `validate` function used during
         // optimistic synchronization.
 
         // Corner case when adding the first element of the list
-        OptimisticSetNode* vNode = head;
+        OptimisticSetNode<Lock>* vNode = head;
         if (!p) {
             return (head == c);
         }
@@ -67,7 +69,7 @@ public:
 
         // If the list was empty
         if (!head) {
-            OptimisticSetNode* addedNode = new OptimisticSetNode{ elem, nullptr };
+            OptimisticSetNode<Lock>* addedNode = new OptimisticSetNode<Lock>{ elem, nullptr };
             head = addedNode;
             head->next = nullptr;
             result = true;
@@ -76,8 +78,8 @@ public:
 
         // First check to see if the element can be added, and if it's not in the list, we add it at the end
         while (true) {
-            OptimisticSetNode* p = nullptr;
-            OptimisticSetNode* c = head;
+            OptimisticSetNode<Lock>* p = nullptr;
+            OptimisticSetNode<Lock>* c = head;
             while (c && c->value < elem) {
                 p = c;
                 c = c->next;
@@ -90,7 +92,7 @@ public:
             if (c) c->lock.lock();
 
             if (validate(p, c)) {
-                OptimisticSetNode* addedNode = new OptimisticSetNode{ elem, nullptr };
+                OptimisticSetNode<Lock>* addedNode = new OptimisticSetNode<Lock>{ elem, nullptr };
                 if (p) p->next = addedNode;
                 if (!p) head = addedNode;
                 addedNode->next = c;
@@ -115,7 +117,7 @@ public:
         // Three cases, elem is head, elem is anything in between or elem is tail
         // elem is head:
         if (head && head->value == elem) {
-            OptimisticSetNode* c = head;
+            OptimisticSetNode<Lock>* c = head;
             c->lock.lock();
             if (validate(nullptr, c)) {
                 head = c->next;
@@ -128,8 +130,8 @@ public:
 
         //elem is anything in between or elem is tail
         while (true) {
-            OptimisticSetNode* p = nullptr;
-            OptimisticSetNode* c = head;
+            OptimisticSetNode<Lock>* p = nullptr;
+            OptimisticSetNode<Lock>* c = head;
             while (c && c->value != elem) {
                 p = c;
                 c = c->next;
@@ -161,7 +163,7 @@ public:
         bool result = false;
         // A01: Add code to check if the element is inside the set and update `result`.
 
-        OptimisticSetNode* c = head;
+        OptimisticSetNode<Lock>* c = head;
 
         while (c) {
             c->lock.lock();
@@ -181,7 +183,7 @@ public:
     void print_state() override {
         // A01: Optionally, add code to print the state. This is useful for debugging,
         // but not part of the assignment
-        OptimisticSetNode* c = head;
+        OptimisticSetNode<Lock>* c = head;
         std::cout << "OptimisticSet { ";
         while (c != nullptr) {
             std::cout << c->value << " ";
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <climits>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+
+#include "set.hpp"
+
+/// The node used for the linked list implementation of a set in the [`RwCoarseSet`]
+/// class.
+struct RwCoarseSetNode {
+    int value;
+    RwCoarseSetNode* next;
+};
+
+/// A set implementation using a linked list with one coarse grained
+/// reader-writer lock. `ctn` only reads the list, so it takes the lock in
+/// shared mode and any number of `ctn` calls can run at the same time, while
+/// `add` and `rmv` take it exclusively. `RwLock` can be `std::shared_mutex` or
+/// one of the locks in `rw_locks.hpp`.
+template <typename RwLock = std::shared_mutex>
+class RwCoarseSet : public Set {
+private:
+    RwCoarseSetNode* head;
+    RwLock lock;
+public:
+    RwCoarseSet() {
+        head = new RwCoarseSetNode{ INT_MIN, nullptr };
+        head->next = new RwCoarseSetNode{ INT_MAX, nullptr };
+    }
+
+    ~RwCoarseSet() override {
+        while (head != nullptr) {
+            RwCoarseSetNode* temp = head;
+            head = head->next;
+            delete temp;
+        }
+    }
+
+    bool add(int elem) override {
+        std::unique_lock<RwLock> guard(lock);
+        RwCoarseSetNode* prev = head;
+        RwCoarseSetNode* curr = head->next;
+        while (curr->value < elem) {
+            prev = curr;
+            curr = curr->next;
+        }
+        if (curr->value == elem) {
+            return false;
+        }
+        prev->next = new RwCoarseSetNode{ elem, curr };
+        return true;
+    }
+
+    bool rmv(int elem) override {
+        std::unique_lock<RwLock> guard(lock);
+        RwCoarseSetNode* prev = head;
+        RwCoarseSetNode* curr = head->next;
+        while (curr->value < elem) {
+            prev = curr;
+            curr = curr->next;
+        }
+        if (curr->value != elem) {
+            return false;
+        }
+        prev->next = curr->next;
+        delete curr;
+        return true;
+    }
+
+    bool ctn(int elem) override {
+        std::shared_lock<RwLock> guard(lock);
+        RwCoarseSetNode* curr = head->next;
+        while (curr->value < elem) {
+            curr = curr->next;
+        }
+        return curr->value == elem;
+    }
+
+    void print_state() override {
+        std::shared_lock<RwLock> guard(lock);
+        std::cout << "RwCoarseSet { ";
+        for (RwCoarseSetNode* c = head->next; c->next != nullptr; c = c->next) {
+            std::cout << c->value << " ";
+        }
+        std::cout << "}" << std::endl;
+    }
+};
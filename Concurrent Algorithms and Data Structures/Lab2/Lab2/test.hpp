@@ -2,7 +2,11 @@
 
 #include "monitoring.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 template <class CDS, typename Op>
 void worker_thread_func(CDS* data_structure, OpGenerator<Op>* generator, int thread_id) {
@@ -32,7 +36,7 @@ void run_data_structure_n_threads(
             worker_thread_func<CDS, Op>,
             std::ref(concurrent_data_structure),
             std::ref(generator[thread_id]),
-            std::ref(thread_id)
+            thread_id
         );
     }
 
@@ -80,3 +84,160 @@ bool run_data_structure_n_threads_with_monitor(
 
     return monitor->is_valid();
 }
+
+// Shared state of the reader-writer lock tests. It lives on the heap, so it
+// can be left to the threads of a test that deadlocked.
+template <typename RwLock>
+struct rw_lock_test_state {
+    RwLock lock;
+    std::atomic<int> readers_inside{0};
+    std::atomic<int> writers_inside{0};
+    std::atomic<bool> overlap{false};
+    std::atomic<long> progress{0};
+    std::atomic<int> finished{0};
+
+    void read() {
+        lock.lock_shared();
+        readers_inside++;
+        if (writers_inside.load() != 0) {
+            overlap = true;
+        }
+        readers_inside--;
+        lock.unlock_shared();
+        progress++;
+    }
+
+    // expects the lock to be held already
+    void write() {
+        if (writers_inside++ != 0 || readers_inside.load() != 0) {
+            overlap = true;
+        }
+        writers_inside--;
+        lock.unlock();
+        progress++;
+    }
+};
+
+// Joins the threads of a reader-writer lock test and deletes its state.
+// Spinning threads may take a whole time slice per hand-over when there are
+// fewer cores than threads, so only a lack of progress for `timeout_seconds`
+// counts as a deadlock; the threads and the state are then left behind.
+template <typename RwLock>
+bool finish_rw_lock_test(rw_lock_test_state<RwLock>* state, std::vector<std::thread>& threads, int timeout_seconds) {
+    long last_progress = -1;
+    auto last_change = std::chrono::steady_clock::now();
+    while (state->finished.load() != (int)threads.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        long progress = state->progress.load();
+        if (progress != last_progress) {
+            last_progress = progress;
+            last_change = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - last_change > std::chrono::seconds(timeout_seconds)) {
+            std::cout << "  - no progress for " << timeout_seconds << " seconds: deadlock" << std::endl;
+            for (std::thread& thread : threads) {
+                thread.detach();
+            }
+            return false;
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool valid = !state->overlap.load();
+    delete state;
+    if (!valid) {
+        std::cout << "  - a writer was inside together with another thread" << std::endl;
+        return false;
+    }
+    std::cout << "  - ok" << std::endl;
+    return true;
+}
+
+// A reader comes in during a write phase and waits for it to end. The writer
+// then unlocks, fails a `try_lock` (the reader is inside, or still waiting)
+// and locks again right away. The failed `try_lock` must leave the lock as it
+// found it, or the second write phase can look like the first one to the
+// reader, which then waits for it while the writer waits for the reader.
+template <typename RwLock>
+bool test_rw_lock_try_lock(char const* lock_name, int rounds = 100, int timeout_seconds = 5) {
+    std::cout << "## Testing `" << lock_name << "` with try_lock after a write phase" << std::endl;
+
+    rw_lock_test_state<RwLock>* state = new rw_lock_test_state<RwLock>();
+    // the round the reader may start, and the last one it has finished
+    std::atomic<int>* go = new std::atomic<int>(-1);
+    std::atomic<int>* done = new std::atomic<int>(-1);
+
+    auto writer = [state, go, done, rounds]() {
+        for (int i = 0; i < rounds; i++) {
+            state->lock.lock();
+            go->store(i);
+            // let the reader get to its lock_shared
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            state->write();
+            if (state->lock.try_lock()) {
+                state->write();
+            }
+            state->lock.lock();
+            state->write();
+            while (done->load() != i) {
+                std::this_thread::yield();
+            }
+        }
+        state->finished++;
+    };
+    auto reader = [state, go, done, rounds]() {
+        for (int i = 0; i < rounds; i++) {
+            while (go->load() != i) {
+                std::this_thread::yield();
+            }
+            state->read();
+            done->store(i);
+        }
+        state->finished++;
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(writer);
+    threads.emplace_back(reader);
+    bool valid = finish_rw_lock_test(state, threads, timeout_seconds);
+    if (valid) {
+        delete go;
+        delete done;
+    }
+    return valid;
+}
+
+// Mixes writers that use `try_lock` (falling back to `lock`) with readers
+// that use `lock_shared`.
+template <typename RwLock>
+bool test_rw_lock_mixed(char const* lock_name, int thread_count = 4, int rounds = 1000, int timeout_seconds = 5) {
+    std::cout << "## Testing `" << lock_name << "` with " << thread_count << " threads mixing try_lock and lock_shared" << std::endl;
+
+    rw_lock_test_state<RwLock>* state = new rw_lock_test_state<RwLock>();
+    auto reader = [state, rounds]() {
+        for (int i = 0; i < rounds; i++) {
+            state->read();
+        }
+        state->finished++;
+    };
+    auto writer = [state, rounds]() {
+        for (int i = 0; i < rounds; i++) {
+            if (!state->lock.try_lock()) {
+                state->lock.lock();
+            }
+            state->write();
+        }
+        state->finished++;
+    };
+
+    std::vector<std::thread> threads;
+    for (int thread_id = 0; thread_id < thread_count; thread_id++) {
+        if (thread_id % 2 == 0) {
+            threads.emplace_back(reader);
+        } else {
+            threads.emplace_back(writer);
+        }
+    }
+    return finish_rw_lock_test(state, threads, timeout_seconds);
+}